@@ -1,6 +1,8 @@
 //! Benchmarks for `UDPipe` parsing performance.
 //!
-//! Measures parsing throughput for short, medium, and long text inputs.
+//! Measures parsing throughput for short, medium, and long text inputs, how
+//! batch and pipelined parsing scale across threads, and what each pipeline
+//! stage costs.
 
 #![allow(clippy::print_stderr, reason = "benchmarks use stderr for progress")]
 #![allow(
@@ -13,33 +15,34 @@
 )]
 
 use std::hint::black_box;
-use std::sync::{Mutex, MutexGuard, OnceLock};
+use std::sync::OnceLock;
 
-use criterion::{Criterion, Throughput, criterion_group, criterion_main};
+use criterion::{BenchmarkId, Criterion, Throughput, criterion_group, criterion_main};
 
 /// Language model to download and use for benchmarks.
 const MODEL_LANGUAGE: &str = "english-ewt";
 
-/// Cached model and temp directory (kept alive for the duration of benchmarks).
-/// Model is wrapped in `Mutex` because `UDPipe` is not thread-safe.
-static MODEL: OnceLock<(tempfile::TempDir, Mutex<udpipe_rs::Model>)> = OnceLock::new();
-
-/// Returns a lock guard to the shared model, initializing it on first call.
-fn get_model() -> MutexGuard<'static, udpipe_rs::Model> {
-    MODEL
-        .get_or_init(|| {
-            let temp_dir = tempfile::tempdir().expect("Failed to create temp directory");
-
-            eprintln!("Downloading {MODEL_LANGUAGE} model for benchmarks...");
-            let model_path = udpipe_rs::download_model(MODEL_LANGUAGE, temp_dir.path())
-                .expect("Failed to download model for benchmarks");
-
-            let model = udpipe_rs::Model::load(&model_path).expect("Failed to load model");
-            (temp_dir, Mutex::new(model))
-        })
-        .1
-        .lock()
-        .expect("Model mutex poisoned")
+/// Cached model, its file path and temp directory (kept alive for the duration
+/// of benchmarks).
+static MODEL: OnceLock<(tempfile::TempDir, String, udpipe_rs::Model)> = OnceLock::new();
+
+/// Returns the shared model state, initializing it on first call.
+fn get_model_state() -> &'static (tempfile::TempDir, String, udpipe_rs::Model) {
+    MODEL.get_or_init(|| {
+        let temp_dir = tempfile::tempdir().expect("Failed to create temp directory");
+
+        eprintln!("Downloading {MODEL_LANGUAGE} model for benchmarks...");
+        let model_path = udpipe_rs::download_model(MODEL_LANGUAGE, temp_dir.path())
+            .expect("Failed to download model for benchmarks");
+
+        let model = udpipe_rs::Model::load(&model_path).expect("Failed to load model");
+        (temp_dir, model_path, model)
+    })
+}
+
+/// Returns the shared model, initializing it on first call.
+fn get_model() -> &'static udpipe_rs::Model {
+    &get_model_state().2
 }
 
 /// Parse text and collect all sentences.
@@ -54,7 +57,7 @@ fn parse_all(text: &str) -> Vec<udpipe_rs::Sentence> {
 /// Benchmarks parsing performance on various text lengths.
 fn bench_parse(c: &mut Criterion) {
     // Initialize model before benchmarking (download happens here)
-    drop(get_model());
+    get_model();
 
     let short_text = "The quick brown fox jumps over the lazy dog.";
     let medium_text = "The quick brown fox jumps over the lazy dog. \
@@ -88,5 +91,336 @@ fn bench_parse(c: &mut Criterion) {
     group.finish();
 }
 
-criterion_group!(benches, bench_parse);
+/// Benchmarks [`udpipe_rs::Model::parse_batch_with`] from 1 thread up to one
+/// per available core, doubling each step.
+fn bench_parse_batch(c: &mut Criterion) {
+    let model = get_model();
+
+    let document = "Natural language processing is a subfield of linguistics. \
+        It is concerned with the interactions between computers and human \
+        language. The goal is a computer capable of understanding documents.";
+    let documents = vec![document; 64];
+    let total_bytes: usize = documents.iter().map(|d| d.len()).sum();
+
+    let max_threads = std::thread::available_parallelism().map_or(1, std::num::NonZeroUsize::get);
+    let mut thread_counts: Vec<usize> = std::iter::successors(Some(1_usize), |n| Some(n * 2))
+        .take_while(|&n| n < max_threads)
+        .collect();
+    thread_counts.push(max_threads);
+
+    let mut group = c.benchmark_group("parse_batch");
+    group.throughput(Throughput::Bytes(total_bytes as u64));
+    for threads in thread_counts {
+        let options = udpipe_rs::BatchOptions::default().threads(threads);
+        group.bench_with_input(
+            BenchmarkId::from_parameter(threads),
+            &options,
+            |b, &options| {
+                b.iter(|| model.parse_batch_with(black_box(&documents), options));
+            },
+        );
+    }
+    group.finish();
+}
+
+/// Benchmarks one long document parsed sequentially and through
+/// [`udpipe_rs::Model::pipelined_parser`].
+fn bench_pipelined(c: &mut Criterion) {
+    let model = get_model();
+
+    let document = "Natural language processing is a subfield of linguistics. \
+        It is concerned with the interactions between computers and human \
+        language. The goal is a computer capable of understanding documents. "
+        .repeat(32);
+
+    let mut group = c.benchmark_group("pipelined");
+    group.throughput(Throughput::Bytes(document.len() as u64));
+    group.bench_function("sequential", |b| {
+        b.iter(|| parse_all(black_box(&document)));
+    });
+    group.bench_function("pipelined", |b| {
+        b.iter(|| {
+            std::thread::scope(|s| {
+                model
+                    .pipelined_parser(
+                        s,
+                        black_box(&document),
+                        udpipe_rs::PipelineOptions::default(),
+                    )
+                    .expect("Failed to create parser")
+                    .collect::<Result<Vec<_>, _>>()
+                    .expect("Failed to parse")
+            })
+        });
+    });
+    group.finish();
+}
+
+/// Benchmarks the long text with the pipeline stopped after each stage.
+fn bench_stages(c: &mut Criterion) {
+    let model = get_model();
+
+    let text = "Natural language processing is a subfield of linguistics. \
+        It is concerned with the interactions between computers and human \
+        language. The goal is a computer capable of understanding documents.";
+
+    let mut group = c.benchmark_group("stages");
+    group.throughput(Throughput::Bytes(text.len() as u64));
+    for stages in [
+        udpipe_rs::Stages::Tokenize,
+        udpipe_rs::Stages::Tag,
+        udpipe_rs::Stages::Parse,
+    ] {
+        let options = udpipe_rs::ParseOptions::default().stages(stages);
+        group.bench_with_input(
+            BenchmarkId::from_parameter(format!("{stages:?}")),
+            &options,
+            |b, &options| {
+                b.iter(|| {
+                    model
+                        .parser_with_options(black_box(text), options)
+                        .expect("Failed to create parser")
+                        .collect::<Result<Vec<_>, _>>()
+                        .expect("Failed to parse")
+                });
+            },
+        );
+    }
+    group.finish();
+}
+
+/// Benchmark many tiny documents: a fresh parser per document vs. one reused
+/// parser.
+fn bench_reusable(c: &mut Criterion) {
+    let model = get_model();
+
+    let queries = [
+        "Where is the station?",
+        "Cheap flights to Prague",
+        "How do I reset my password?",
+        "Weather tomorrow",
+    ];
+
+    let mut group = c.benchmark_group("reusable");
+    group.throughput(Throughput::Elements(queries.len() as u64));
+    group.bench_function("fresh", |b| {
+        b.iter(|| {
+            for query in queries {
+                model
+                    .parser(black_box(query))
+                    .expect("Failed to create parser")
+                    .collect::<Result<Vec<_>, _>>()
+                    .expect("Failed to parse");
+            }
+        });
+    });
+    group.bench_function("reused", |b| {
+        let mut parser = model.reusable_parser().expect("Failed to create parser");
+        b.iter(|| {
+            for query in queries {
+                parser
+                    .parse(black_box(query))
+                    .expect("Failed to reset parser")
+                    .collect::<Result<Vec<_>, _>>()
+                    .expect("Failed to parse");
+            }
+        });
+    });
+    group.finish();
+}
+
+/// Benchmark columnar output against transposing owned sentences into the
+/// same columns.
+fn bench_columnar(c: &mut Criterion) {
+    let model = get_model();
+
+    let texts = [
+        "The quick brown fox jumps over the lazy dog.",
+        "Natural language processing is a subfield of linguistics.",
+        "It is concerned with the interactions between computers and human language.",
+    ];
+
+    let mut group = c.benchmark_group("columnar");
+    group.bench_function("columnar", |b| {
+        b.iter(|| {
+            model
+                .parse_columnar(black_box(&texts))
+                .expect("Failed to parse")
+        });
+    });
+    group.bench_function("transposed", |b| {
+        b.iter(|| {
+            let mut forms = String::new();
+            let mut upostags = Vec::new();
+            let mut heads = Vec::new();
+            for text in texts {
+                for sentence in parse_all(black_box(text)) {
+                    for word in sentence.words {
+                        forms.push_str(&word.form);
+                        upostags.push(word.upostag);
+                        heads.push(word.head);
+                    }
+                }
+            }
+            (forms, upostags, heads)
+        });
+    });
+    group.finish();
+}
+
+/// Benchmark many threads sending short requests, each with its own parser
+/// versus through a micro-batching scheduler.
+fn bench_micro_batch(c: &mut Criterion) {
+    let model_path = &get_model_state().1;
+    let model = std::sync::Arc::new(udpipe_rs::Model::load(model_path).expect("Failed to load"));
+
+    let queries = [
+        "Where is the station?",
+        "Cheap flights to Prague",
+        "How do I reset my password?",
+        "Weather tomorrow",
+    ];
+    let clients = 16;
+
+    let mut group = c.benchmark_group("micro_batch");
+    group.throughput(Throughput::Elements((clients * queries.len()) as u64));
+    group.bench_function("per_request", |b| {
+        b.iter(|| {
+            std::thread::scope(|s| {
+                for _ in 0..clients {
+                    s.spawn(|| {
+                        for query in queries {
+                            model
+                                .parser(black_box(query))
+                                .expect("Failed to create parser")
+                                .collect::<Result<Vec<_>, _>>()
+                                .expect("Failed to parse");
+                        }
+                    });
+                }
+            });
+        });
+    });
+    for max_wait_us in [0, 200] {
+        let options = udpipe_rs::MicroBatchOptions::default()
+            .max_wait(std::time::Duration::from_micros(max_wait_us));
+        let batcher = udpipe_rs::MicroBatcher::new(std::sync::Arc::clone(&model), options)
+            .expect("Failed to start batcher");
+        group.bench_with_input(
+            BenchmarkId::new("batched_wait_us", max_wait_us),
+            &batcher,
+            |b, batcher| {
+                b.iter(|| {
+                    std::thread::scope(|s| {
+                        for _ in 0..clients {
+                            s.spawn(|| {
+                                for query in queries {
+                                    batcher.parse(black_box(query)).expect("Failed to parse");
+                                }
+                            });
+                        }
+                    });
+                });
+            },
+        );
+        let stats = batcher.stats();
+        eprintln!(
+            "max_wait {max_wait_us}us: {} requests in {} batches, mean queueing {:?}, max {:?}",
+            stats.requests,
+            stats.batches,
+            stats.queue_mean(),
+            stats.queue_max
+        );
+    }
+    group.finish();
+}
+
+/// Benchmark a corpus with one document much larger than the rest, with and
+/// without splitting large documents across workers.
+fn bench_corpus(c: &mut Criterion) {
+    let model = get_model();
+
+    let sentence = "The quick brown fox jumps over the lazy dog. ";
+    let mut texts = vec![sentence.repeat(2000)];
+    texts.extend(std::iter::repeat_n(sentence.repeat(5), 200));
+    let threads = std::thread::available_parallelism().map_or(4, std::num::NonZeroUsize::get);
+
+    let mut group = c.benchmark_group("corpus");
+    group.throughput(Throughput::Bytes(
+        texts.iter().map(|text| text.len() as u64).sum(),
+    ));
+    for (name, split_bytes) in [("whole", usize::MAX), ("split", 64 << 10)] {
+        let options = udpipe_rs::CorpusOptions::default()
+            .workers(threads)
+            .split_bytes(split_bytes);
+        group.bench_function(name, |b| {
+            b.iter(|| {
+                model
+                    .parse_corpus(black_box(&texts), options)
+                    .expect("Failed to start workers")
+            });
+        });
+        let output = model
+            .parse_corpus(&texts, options)
+            .expect("Failed to start workers");
+        let rates: Vec<_> = output
+            .workers
+            .iter()
+            .map(udpipe_rs::WorkerStats::words_per_second)
+            .collect();
+        eprintln!("{name}: words/s per worker {rates:?}");
+    }
+    group.finish();
+}
+
+/// Benchmark 1 to 64 threads parsing concurrently with one shared model, with
+/// per-stage stats off and on.
+fn bench_contention(c: &mut Criterion) {
+    let model_path = &get_model_state().1;
+    let model = udpipe_rs::Model::load(model_path).expect("Failed to load");
+
+    let text = "The quick brown fox jumps over the lazy dog. ".repeat(8);
+    let sentences = parse_all(&text).len();
+
+    let mut group = c.benchmark_group("contention");
+    for stats in [false, true] {
+        model.set_stats_enabled(stats);
+        for threads in [1, 8, 32, 64] {
+            group.throughput(Throughput::Elements((threads * sentences) as u64));
+            group.bench_with_input(
+                BenchmarkId::new(if stats { "stats" } else { "plain" }, threads),
+                &threads,
+                |b, &threads| {
+                    b.iter(|| {
+                        std::thread::scope(|s| {
+                            for _ in 0..threads {
+                                s.spawn(|| {
+                                    model
+                                        .parser(black_box(&text))
+                                        .expect("Failed to create parser")
+                                        .collect::<Result<Vec<_>, _>>()
+                                        .expect("Failed to parse")
+                                });
+                            }
+                        });
+                    });
+                },
+            );
+        }
+    }
+    group.finish();
+}
+
+criterion_group!(
+    benches,
+    bench_parse,
+    bench_parse_batch,
+    bench_pipelined,
+    bench_stages,
+    bench_reusable,
+    bench_columnar,
+    bench_micro_batch,
+    bench_corpus,
+    bench_contention
+);
 criterion_main!(benches);
@@ -12,11 +12,20 @@ extern "C" {
 struct UdpipeModel;
 struct UdpipeParser;
 struct UdpipeSentence;
+struct UdpipeRawSentence;
+
+// A UdpipeSentence returned by udpipe_parser_next is owned by the parser and
+// reused by the next udpipe_parser_next call. All pointers obtained from it are
+// valid only until then (or until udpipe_parser_free).
+
+// Borrowed UTF-8 string with explicit length. data[len] is always '\0'.
+struct UdpipeStr {
+  const char *data;
+  size_t len;
+};
 
 // Word structure with Universal Dependencies annotations.
 // Note: The virtual root word (index 0 in UDPipe) is excluded from results.
-// All string pointers are valid only until the next sentence API call or
-// udpipe_sentence_free on the same UdpipeSentence.
 struct UdpipeWord {
   const char *form;        // Surface form
   const char *lemma;       // Lemma (dictionary form)
@@ -30,10 +39,29 @@ struct UdpipeWord {
   int32_t id;              // 1-based word index within sentence
   int32_t head;            // Head word index (0 = root)
   int32_t children_count;  // Number of children
+  size_t start;            // Byte offset of the token in the parser's text
+  size_t end;              // Byte offset past its end (UDPIPE_TOKENIZER_RANGES)
+};
+
+// Same as UdpipeWord, with lengths so callers need not strlen each field.
+struct UdpipeWordView {
+  UdpipeStr form;
+  UdpipeStr lemma;
+  UdpipeStr upostag;
+  UdpipeStr xpostag;
+  UdpipeStr feats;
+  UdpipeStr deprel;
+  UdpipeStr deps;
+  UdpipeStr misc;
+  const int32_t *children;
+  int32_t id;
+  int32_t head;
+  int32_t children_count;
+  size_t start;
+  size_t end;
 };
 
 // Multiword token (e.g., "don't" -> "do" + "n't").
-// String pointers valid until next sentence API call or udpipe_sentence_free.
 struct UdpipeMultiwordToken {
   const char *form; // Surface form of the multiword token
   const char *misc; // Miscellaneous annotations
@@ -41,6 +69,68 @@ struct UdpipeMultiwordToken {
   int32_t id_last;  // Last word ID in the token range
 };
 
+// Same as UdpipeMultiwordToken, with lengths.
+struct UdpipeMultiwordTokenView {
+  UdpipeStr form;
+  UdpipeStr misc;
+  int32_t id_first;
+  int32_t id_last;
+};
+
+// Last pipeline stage a parser runs; each stage includes the ones before it.
+enum {
+  UDPIPE_STAGE_TOKENIZE = 0, // Sentence splitting and tokenization only
+  UDPIPE_STAGE_TAG = 1,      // + POS tags, features and lemmas
+  UDPIPE_STAGE_PARSE = 2,    // + dependency heads and relations (default)
+};
+
+// Result columns copied out of UDPipe. Unselected strings read as empty,
+// unselected children as none; id and head are always filled in.
+enum {
+  UDPIPE_FIELD_FORM = 1U << 0,
+  UDPIPE_FIELD_LEMMA = 1U << 1,
+  UDPIPE_FIELD_UPOSTAG = 1U << 2,
+  UDPIPE_FIELD_XPOSTAG = 1U << 3,
+  UDPIPE_FIELD_FEATS = 1U << 4,
+  UDPIPE_FIELD_DEPREL = 1U << 5,
+  UDPIPE_FIELD_DEPS = 1U << 6,
+  UDPIPE_FIELD_MISC = 1U << 7,
+  UDPIPE_FIELD_CHILDREN = 1U << 8,
+  UDPIPE_FIELD_MULTIWORD_TOKENS = 1U << 9,
+  UDPIPE_FIELD_COMMENTS = 1U << 10,
+  UDPIPE_FIELD_ALL = (1U << 11) - 1,
+};
+
+// Tokenizer modes.
+enum {
+  // Input has one sentence per line; only tokenization is done.
+  UDPIPE_TOKENIZER_PRESEGMENTED = 1U << 0,
+  // Fill in the start/end byte offsets of each word, relative to the text
+  // last given to the parser. Words of a multiword token share its range.
+  // Without this flag (or for raw sentences built from forms) both are 0.
+  UDPIPE_TOKENIZER_RANGES = 1U << 1,
+};
+
+// Options for udpipe_parser_new_with_options. A null pointer means defaults.
+struct UdpipeParseOptions {
+  int32_t stages;     // UDPIPE_STAGE_*
+  uint32_t fields;    // UDPIPE_FIELD_* mask
+  uint32_t tokenizer; // UDPIPE_TOKENIZER_* mask
+};
+
+// Per-stage counters. Times are wall-clock nanoseconds spent in each stage;
+// build_ns also includes time the caller reports for converting results.
+// `words` excludes the virtual root; `bytes` counts input text.
+struct UdpipeStats {
+  uint64_t tokenize_ns;
+  uint64_t tag_ns;
+  uint64_t parse_ns;
+  uint64_t build_ns;
+  uint64_t sentences;
+  uint64_t words;
+  uint64_t bytes;
+};
+
 // Model functions
 // On failure, return nullptr. If out_error != nullptr, set *out_error to the
 // last error message (valid only until the next API call on this thread; copy
@@ -49,34 +139,108 @@ auto udpipe_model_load(const char *model_path, const char **out_error)
     -> UdpipeModel *;
 auto udpipe_model_load_from_memory(const uint8_t *data, size_t len,
                                    const char **out_error) -> UdpipeModel *;
+// Like udpipe_model_load, but reads the file through a read-only memory
+// mapping instead of a buffered stream. Pages are dropped from the mapping as
+// they are consumed, and the mapping is released before returning. Falls back
+// to udpipe_model_load where mmap is unavailable.
+auto udpipe_model_load_mmap(const char *model_path, const char **out_error)
+    -> UdpipeModel *;
 void udpipe_model_free(UdpipeModel *model);
 
+// Thread placement, used to build and pick NUMA-local model replicas.
+// Restrict the calling thread to the `len` CPUs in `cpus`; returns false on
+// failure and where affinity is unsupported (everywhere but Linux).
+auto udpipe_thread_set_cpus(const size_t *cpus, size_t len) -> bool;
+// The CPU the calling thread is running on, or -1 where unknown.
+auto udpipe_thread_current_cpu() -> int32_t;
+
+// Stats functions. Collection is off by default; when off, no clocks are read.
+// A parser samples the flag when it is created. Model stats are totals over
+// all parsers (and raw sentences) of the model; parser stats cover one parser
+// and exclude raw sentences after tokenization.
+void udpipe_model_set_stats_enabled(UdpipeModel *model, bool enabled);
+auto udpipe_model_stats_enabled(UdpipeModel *model) -> bool;
+auto udpipe_model_get_stats(UdpipeModel *model) -> UdpipeStats;
+void udpipe_model_reset_stats(UdpipeModel *model);
+auto udpipe_parser_get_stats(UdpipeParser *parser) -> UdpipeStats;
+// Add caller-side conversion time to build_ns (no-op when stats are off).
+void udpipe_parser_add_build_ns(UdpipeParser *parser, uint64_t ns);
+void udpipe_raw_sentence_add_build_ns(UdpipeRawSentence *raw, uint64_t ns);
+
 // Parser functions - streaming API
 // On failure, return nullptr. If out_error != nullptr, set *out_error to the
 // error message (valid until next API call on this thread).
+// `text` is read in place, not copied: it need not be NUL-terminated (and may
+// contain NUL bytes), but must stay valid until udpipe_parser_free.
 auto udpipe_parser_new(UdpipeModel *model, const char *text, size_t text_len,
                        const char **out_error) -> UdpipeParser *;
+// Skipped stages leave their fields empty; heads are -1 without parsing.
+auto udpipe_parser_new_with_options(UdpipeModel *model, const char *text,
+                                    size_t text_len,
+                                    const UdpipeParseOptions *options,
+                                    const char **out_error) -> UdpipeParser *;
+// Returned sentence is owned by the parser (see above); do not free it.
 auto udpipe_parser_next(UdpipeParser *parser, const char **out_error)
     -> UdpipeSentence *;
 auto udpipe_parser_has_error(UdpipeParser *parser) -> bool;
+// Start a new document with `text`, reusing the parser's tokenizer, options
+// and buffers; clears any earlier error. `text` must stay valid as for
+// udpipe_parser_new, and the previous text is no longer read.
+auto udpipe_parser_reset(UdpipeParser *parser, const char *text,
+                         size_t text_len, const char **out_error) -> bool;
+// Replace the text of a parser that has returned all sentences of its current
+// text, keeping its tokenizer and options. The previous text is not read after
+// udpipe_parser_next (or udpipe_parser_next_raw) reports its end, so it may be
+// freed or overwritten from then on; the new one must stay valid until the next
+// call or udpipe_parser_free.
+// Fails on a parser that has errored.
+auto udpipe_parser_set_text(UdpipeParser *parser, const char *text,
+                            size_t text_len, const char **out_error) -> bool;
 void udpipe_parser_free(UdpipeParser *parser);
 
+// Raw sentences - run the pipeline stages separately (e.g. on other threads).
+// udpipe_parser_next_raw only tokenizes; the caller owns the returned sentence
+// and frees it with udpipe_raw_sentence_free. End of text and errors are
+// reported as for udpipe_parser_next. A raw sentence may be tagged and parsed
+// on any thread, concurrently with other raw sentences of the same model.
+// Tagging and parsing are no-ops for stages the parser was not created with.
+auto udpipe_parser_next_raw(UdpipeParser *parser, const char **out_error)
+    -> UdpipeRawSentence *;
+// Build a raw sentence from already tokenized word forms, skipping the
+// tokenizer. The forms are copied and need not be NUL-terminated. Only
+// `stages` and `fields` of `options` (may be null) are used.
+auto udpipe_raw_sentence_new(UdpipeModel *model, const UdpipeStr *forms,
+                             size_t count, const UdpipeParseOptions *options,
+                             const char **out_error) -> UdpipeRawSentence *;
+auto udpipe_raw_sentence_tag(UdpipeModel *model, UdpipeRawSentence *raw,
+                             const char **out_error) -> bool;
+auto udpipe_raw_sentence_parse(UdpipeModel *model, UdpipeRawSentence *raw,
+                               const char **out_error) -> bool;
+// Returned sentence is owned by `raw` and valid until the next call on it.
+auto udpipe_raw_sentence_result(UdpipeRawSentence *raw) -> UdpipeSentence *;
+void udpipe_raw_sentence_free(UdpipeRawSentence *raw);
+
 // Sentence functions - words
-void udpipe_sentence_free(UdpipeSentence *sentence);
 auto udpipe_sentence_word_count(UdpipeSentence *sentence) -> int32_t;
 auto udpipe_sentence_get_word(UdpipeSentence *sentence, int32_t index)
     -> UdpipeWord;
+auto udpipe_sentence_get_word_view(UdpipeSentence *sentence, int32_t index)
+    -> UdpipeWordView;
 
 // Sentence functions - multiword tokens
 auto udpipe_sentence_multiword_token_count(UdpipeSentence *sentence) -> int32_t;
 auto udpipe_sentence_get_multiword_token(UdpipeSentence *sentence,
                                          int32_t index) -> UdpipeMultiwordToken;
+auto udpipe_sentence_get_multiword_token_view(UdpipeSentence *sentence,
+                                              int32_t index)
+    -> UdpipeMultiwordTokenView;
 
 // Sentence functions - comments
 auto udpipe_sentence_comment_count(UdpipeSentence *sentence) -> int32_t;
-// Returned pointer valid until next sentence API call or udpipe_sentence_free.
 auto udpipe_sentence_get_comment(UdpipeSentence *sentence, int32_t index)
     -> const char *;
+auto udpipe_sentence_get_comment_view(UdpipeSentence *sentence, int32_t index)
+    -> UdpipeStr;
 
 #ifdef __cplusplus
 }
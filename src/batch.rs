@@ -0,0 +1,197 @@
+//! Parallel batch parsing over a pool of worker threads sharing one [`Model`].
+
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::mpsc;
+
+use crate::{Model, ParseOptions, Sentence, UdpipeError};
+
+/// Options for [`Model::parse_batch_with`] and [`Model::parse_batch_for_each`].
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct BatchOptions {
+    /// Number of worker threads. `0` uses
+    /// [`std::thread::available_parallelism`].
+    pub threads: usize,
+    /// Options for the parser of each document.
+    pub parse: ParseOptions,
+}
+
+impl BatchOptions {
+    /// Set the number of worker threads (`0` = one per available core).
+    #[must_use]
+    pub const fn threads(mut self, threads: usize) -> Self {
+        self.threads = threads;
+        self
+    }
+
+    /// Set the options for the parser of each document.
+    #[must_use]
+    pub const fn parse_options(mut self, parse: ParseOptions) -> Self {
+        self.parse = parse;
+        self
+    }
+
+    /// Number of workers to spawn for `jobs` documents.
+    fn worker_count(self, jobs: usize) -> usize {
+        let threads = if self.threads == 0 {
+            std::thread::available_parallelism().map_or(1, std::num::NonZeroUsize::get)
+        } else {
+            self.threads
+        };
+        threads.min(jobs)
+    }
+}
+
+impl Model {
+    /// Parse many documents in parallel, one worker per available core.
+    ///
+    /// Documents are distributed dynamically over the workers, which all share
+    /// this model. The output has one entry per input document, in input
+    /// order; a failing document does not affect the others.
+    ///
+    /// # Example
+    /// ```no_run
+    /// use udpipe_rs::Model;
+    ///
+    /// let model = Model::load("english-ewt-ud-2.5-191206.udpipe").expect("Failed to load");
+    /// let results = model.parse_batch(&["First document.", "Second document."]);
+    /// for sentences in results {
+    ///     let sentences = sentences.expect("Failed to parse");
+    ///     println!("{} sentences", sentences.len());
+    /// }
+    /// ```
+    #[must_use]
+    pub fn parse_batch<S>(&self, texts: &[S]) -> Vec<Result<Vec<Sentence>, UdpipeError>>
+    where
+        S: AsRef<str> + Sync,
+    {
+        self.parse_batch_with(texts, BatchOptions::default())
+    }
+
+    /// Parse many documents in parallel with explicit [`BatchOptions`].
+    ///
+    /// See [`Model::parse_batch`].
+    #[must_use]
+    pub fn parse_batch_with<S>(
+        &self,
+        texts: &[S],
+        options: BatchOptions,
+    ) -> Vec<Result<Vec<Sentence>, UdpipeError>>
+    where
+        S: AsRef<str> + Sync,
+    {
+        let mut results = Vec::with_capacity(texts.len());
+        self.parse_batch_for_each(texts, options, |_, result| results.push(result));
+        results
+    }
+
+    /// Parse many documents in parallel, streaming each result to `f` in input
+    /// order as soon as it (and every document before it) is done.
+    ///
+    /// `f` runs on the calling thread and receives the document index and its
+    /// result. Documents that finish early are held in a reorder buffer until
+    /// their predecessors complete.
+    ///
+    /// # Example
+    /// ```no_run
+    /// use udpipe_rs::{BatchOptions, Model};
+    ///
+    /// let model = Model::load("english-ewt-ud-2.5-191206.udpipe").expect("Failed to load");
+    /// let texts = ["First document.", "Second document."];
+    /// model.parse_batch_for_each(&texts, BatchOptions::default().threads(4), |idx, result| {
+    ///     println!("{idx}: {:?}", result.map(|sentences| sentences.len()));
+    /// });
+    /// ```
+    pub fn parse_batch_for_each<S, F>(&self, texts: &[S], options: BatchOptions, mut f: F)
+    where
+        S: AsRef<str> + Sync,
+        F: FnMut(usize, Result<Vec<Sentence>, UdpipeError>),
+    {
+        let parse = |text: &S| {
+            self.parser_with_options(text.as_ref(), options.parse)
+                .and_then(Iterator::collect)
+        };
+
+        let workers = options.worker_count(texts.len());
+        if workers <= 1 {
+            for (idx, text) in texts.iter().enumerate() {
+                f(idx, parse(text));
+            }
+            return;
+        }
+
+        let next = AtomicUsize::new(0);
+        let (tx, rx) = mpsc::channel();
+        std::thread::scope(|s| {
+            for _ in 0..workers {
+                let tx = tx.clone();
+                let (next, parse) = (&next, &parse);
+                s.spawn(move || {
+                    loop {
+                        let idx = next.fetch_add(1, Ordering::Relaxed);
+                        let Some(text) = texts.get(idx) else {
+                            break;
+                        };
+                        if tx.send((idx, parse(text))).is_err() {
+                            break;
+                        }
+                    }
+                });
+            }
+            drop(tx);
+
+            let mut pending: Vec<Option<Result<Vec<Sentence>, UdpipeError>>> =
+                std::iter::repeat_with(|| None).take(texts.len()).collect();
+            let mut emitted = 0;
+            for (idx, result) in rx {
+                pending[idx] = Some(result);
+                while let Some(result) = pending.get_mut(emitted).and_then(Option::take) {
+                    f(emitted, result);
+                    emitted += 1;
+                }
+            }
+        });
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_batch_options_default_uses_available_cores() {
+        let options = BatchOptions::default();
+        assert_eq!(options.threads, 0);
+        assert!(options.worker_count(usize::MAX) >= 1);
+    }
+
+    #[test]
+    fn test_batch_options_worker_count_capped_by_jobs() {
+        assert_eq!(BatchOptions::default().threads(8).worker_count(3), 3);
+        assert_eq!(BatchOptions::default().threads(2).worker_count(10), 2);
+        assert_eq!(BatchOptions::default().threads(4).worker_count(0), 0);
+    }
+
+    #[test]
+    fn test_parse_batch_empty() {
+        let model = Model {
+            inner: std::ptr::null_mut(),
+        };
+        let texts: [&str; 0] = [];
+        assert!(model.parse_batch(&texts).is_empty());
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_parse_batch_reports_errors_in_order() {
+        let model = Model {
+            inner: std::ptr::null_mut(),
+        };
+        let texts = ["a", "b", "c", "d", "e"];
+        let mut seen = Vec::new();
+        model.parse_batch_for_each(&texts, BatchOptions::default().threads(3), |idx, result| {
+            assert!(result.is_err());
+            seen.push(idx);
+        });
+        assert_eq!(seen, vec![0, 1, 2, 3, 4]);
+    }
+}
@@ -0,0 +1,580 @@
+//! Columnar (struct-of-arrays) output: one contiguous array per field over all
+//! words of many sentences, for vectorized consumers.
+
+use std::collections::HashMap;
+use std::ops::Range;
+
+use crate::{Model, ParseOptions, SentenceRef, UdpipeError, UdpipeErrorKind, WordRef};
+
+#[cfg(feature = "arrow")]
+mod arrow;
+
+/// A string column: the values of all rows concatenated, with offsets.
+///
+/// Row `i` is `data()[offsets()[i]..offsets()[i + 1]]`.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct StringColumn {
+    /// All values, concatenated.
+    data: String,
+    /// Start of each row in `data`, plus the end of the last row.
+    offsets: Vec<u32>,
+}
+
+impl Default for StringColumn {
+    fn default() -> Self {
+        Self {
+            data: String::new(),
+            offsets: vec![0],
+        }
+    }
+}
+
+impl StringColumn {
+    /// All values, concatenated.
+    #[must_use]
+    pub fn data(&self) -> &str {
+        &self.data
+    }
+
+    /// Byte offset of each row in [`StringColumn::data`], followed by the end
+    /// of the last row (so there is one more offset than rows).
+    #[must_use]
+    pub fn offsets(&self) -> &[u32] {
+        &self.offsets
+    }
+
+    /// Number of rows.
+    #[must_use]
+    pub const fn len(&self) -> usize {
+        self.offsets.len() - 1
+    }
+
+    /// Whether the column has no rows.
+    #[must_use]
+    pub const fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// The value of row `index`.
+    #[must_use]
+    pub fn get(&self, index: usize) -> Option<&str> {
+        let start = *self.offsets.get(index)? as usize;
+        let end = *self.offsets.get(index + 1)? as usize;
+        Some(&self.data[start..end])
+    }
+
+    /// Iterate over the values of all rows.
+    #[must_use]
+    pub fn iter(&self) -> impl ExactSizeIterator<Item = &str> {
+        self.offsets
+            .windows(2)
+            .map(|w| &self.data[w[0] as usize..w[1] as usize])
+    }
+
+    /// Append a row.
+    fn push(&mut self, value: &str) -> Result<(), UdpipeError> {
+        self.data.push_str(value);
+        let end = u32::try_from(self.data.len())
+            .map_err(|_| overflow("string column is larger than 4 GiB"))?;
+        self.offsets.push(end);
+        Ok(())
+    }
+
+    /// Keep only the first `len` rows.
+    fn truncate(&mut self, len: usize) {
+        self.offsets.truncate(len + 1);
+        self.data.truncate(self.offsets[len] as usize);
+    }
+}
+
+/// The distinct values of an interned column, indexed by id.
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct Vocabulary {
+    /// Value of each id.
+    values: Vec<String>,
+    /// Id of each value.
+    ids: HashMap<String, u32>,
+}
+
+impl Vocabulary {
+    /// The value with id `id`.
+    #[must_use]
+    pub fn get(&self, id: u32) -> Option<&str> {
+        self.values.get(id as usize).map(String::as_str)
+    }
+
+    /// The id of `value`, if it occurs in the column.
+    #[must_use]
+    pub fn id(&self, value: &str) -> Option<u32> {
+        self.ids.get(value).copied()
+    }
+
+    /// All values, indexed by id.
+    #[must_use]
+    pub fn values(&self) -> &[String] {
+        &self.values
+    }
+
+    /// Number of distinct values.
+    #[must_use]
+    pub const fn len(&self) -> usize {
+        self.values.len()
+    }
+
+    /// Whether there are no values.
+    #[must_use]
+    pub const fn is_empty(&self) -> bool {
+        self.values.is_empty()
+    }
+
+    /// The id of `value`, adding it if it is new. Fails, without adding it,
+    /// if the id does not fit in `T`.
+    fn intern<T: TryFrom<u32>>(&mut self, value: &str, column: &str) -> Result<T, UdpipeError> {
+        if let Some(&id) = self.ids.get(value) {
+            // Every stored id was checked to fit when it was added.
+            return T::try_from(id).map_err(|_| too_many(column));
+        }
+        let id = u32::try_from(self.values.len()).map_err(|_| too_many(column))?;
+        let result = T::try_from(id).map_err(|_| too_many(column))?;
+        self.values.push(value.to_owned());
+        self.ids.insert(value.to_owned(), id);
+        Ok(result)
+    }
+
+    /// Keep only the first `len` values.
+    fn truncate(&mut self, len: usize) {
+        for value in self.values.drain(len.min(self.values.len())..) {
+            self.ids.remove(&value);
+        }
+    }
+}
+
+/// The error for an interned column with more distinct values than its id type
+/// can hold.
+fn too_many(column: &str) -> UdpipeError {
+    overflow(&format!("too many distinct {column} values"))
+}
+
+/// The error for a batch that outgrew its column types.
+fn overflow(message: &str) -> UdpipeError {
+    UdpipeError::new(UdpipeErrorKind::InvalidInput, message)
+}
+
+/// Words of many sentences, stored column by column.
+///
+/// Row `i` of every column is word `i` of the batch, counting across
+/// sentences in order. Strings with few distinct values (tags, features,
+/// relations) are interned: the column holds small integer ids, resolved
+/// with the matching [`Vocabulary`].
+///
+/// Built by [`Model::parse_columnar`], or from any parser with
+/// [`ColumnarBatch::push`].
+///
+/// # Example
+/// ```no_run
+/// use udpipe_rs::Model;
+///
+/// let model = Model::load("english-ewt-ud-2.5-191206.udpipe").expect("Failed to load");
+/// let batch = model
+///     .parse_columnar(&["The quick brown fox.", "It jumps."])
+///     .expect("Failed to parse");
+/// let nouns = batch.upostag_vocab().id("NOUN");
+/// let noun_count = batch
+///     .upostags()
+///     .iter()
+///     .filter(|&&id| Some(u32::from(id)) == nouns)
+///     .count();
+/// println!("{noun_count} nouns in {} words", batch.word_count());
+/// ```
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct ColumnarBatch {
+    /// First sentence of each document, plus the end of the last one.
+    document_offsets: Vec<u32>,
+    /// First word of each sentence, plus the end of the last one.
+    sentence_offsets: Vec<u32>,
+    /// [`WordRef::form`] of each word.
+    forms: StringColumn,
+    /// [`WordRef::lemma`] of each word.
+    lemmas: StringColumn,
+    /// Interned [`WordRef::upostag`] of each word.
+    upostags: Vec<u8>,
+    /// Values of `upostags`.
+    upostag_vocab: Vocabulary,
+    /// Interned [`WordRef::xpostag`] of each word.
+    xpostags: Vec<u16>,
+    /// Values of `xpostags`.
+    xpostag_vocab: Vocabulary,
+    /// Interned [`WordRef::feats`] of each word.
+    feats: Vec<u16>,
+    /// Values of `feats`.
+    feats_vocab: Vocabulary,
+    /// Interned [`WordRef::deprel`] of each word.
+    deprels: Vec<u16>,
+    /// Values of `deprels`.
+    deprel_vocab: Vocabulary,
+    /// [`WordRef::head`] of each word.
+    heads: Vec<i32>,
+}
+
+impl Default for ColumnarBatch {
+    fn default() -> Self {
+        Self {
+            document_offsets: vec![0],
+            sentence_offsets: vec![0],
+            forms: StringColumn::default(),
+            lemmas: StringColumn::default(),
+            upostags: Vec::new(),
+            upostag_vocab: Vocabulary::default(),
+            xpostags: Vec::new(),
+            xpostag_vocab: Vocabulary::default(),
+            feats: Vec::new(),
+            feats_vocab: Vocabulary::default(),
+            deprels: Vec::new(),
+            deprel_vocab: Vocabulary::default(),
+            heads: Vec::new(),
+        }
+    }
+}
+
+impl ColumnarBatch {
+    /// An empty batch.
+    #[must_use]
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Append the words of `sentence` to the current document.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error, leaving the batch (columns and vocabularies)
+    /// unchanged, if the batch outgrows
+    /// its column types: more than 4 GiB of strings in a column, more than
+    /// 256 distinct `upostag` values or 65536 distinct values of another
+    /// interned column.
+    pub fn push(&mut self, sentence: &SentenceRef<'_>) -> Result<(), UdpipeError> {
+        self.push_words(sentence.words())
+    }
+
+    /// End the current document: sentences pushed from now on belong to the
+    /// next one. [`Model::parse_columnar`] calls this after each text.
+    pub fn finish_document(&mut self) {
+        self.document_offsets.push(self.sentence_count_u32());
+    }
+
+    /// Append one sentence made of `words`.
+    fn push_words<'w>(
+        &mut self,
+        words: impl Iterator<Item = WordRef<'w>>,
+    ) -> Result<(), UdpipeError> {
+        let start = self.word_count();
+        let vocabularies = [
+            self.upostag_vocab.len(),
+            self.xpostag_vocab.len(),
+            self.feats_vocab.len(),
+            self.deprel_vocab.len(),
+        ];
+        for word in words {
+            if let Err(err) = self.push_word(&word) {
+                self.truncate_words(start, vocabularies);
+                return Err(err);
+            }
+        }
+        let Ok(end) = u32::try_from(self.heads.len()) else {
+            self.truncate_words(start, vocabularies);
+            return Err(overflow("more than 4 Gi words in one batch"));
+        };
+        self.sentence_offsets.push(end);
+        Ok(())
+    }
+
+    /// Append one word to every column. On error, columns may be left with
+    /// different lengths; the caller truncates them.
+    fn push_word(&mut self, word: &WordRef<'_>) -> Result<(), UdpipeError> {
+        let upostag = self.upostag_vocab.intern(word.upostag, "upostag")?;
+        let xpostag = self.xpostag_vocab.intern(word.xpostag, "xpostag")?;
+        let feats = self.feats_vocab.intern(word.feats, "feats")?;
+        let deprel = self.deprel_vocab.intern(word.deprel, "deprel")?;
+        self.forms.push(word.form)?;
+        self.lemmas.push(word.lemma)?;
+        self.upostags.push(upostag);
+        self.xpostags.push(xpostag);
+        self.feats.push(feats);
+        self.deprels.push(deprel);
+        self.heads.push(word.head);
+        Ok(())
+    }
+
+    /// Keep only the first `len` words, and the first `vocabularies` values of
+    /// the `upostag`, `xpostag`, `feats` and `deprel` vocabularies.
+    fn truncate_words(&mut self, len: usize, vocabularies: [usize; 4]) {
+        let [upostags, xpostags, feats, deprels] = vocabularies;
+        self.upostag_vocab.truncate(upostags);
+        self.xpostag_vocab.truncate(xpostags);
+        self.feats_vocab.truncate(feats);
+        self.deprel_vocab.truncate(deprels);
+        self.forms.truncate(len);
+        self.lemmas.truncate(len);
+        self.upostags.truncate(len);
+        self.xpostags.truncate(len);
+        self.feats.truncate(len);
+        self.deprels.truncate(len);
+        self.heads.truncate(len);
+    }
+
+    /// Number of sentences, which fits in `u32` because every sentence offset
+    /// does.
+    fn sentence_count_u32(&self) -> u32 {
+        u32::try_from(self.sentence_count()).unwrap_or(u32::MAX)
+    }
+
+    /// Number of documents finished with [`ColumnarBatch::finish_document`].
+    #[must_use]
+    pub const fn document_count(&self) -> usize {
+        self.document_offsets.len() - 1
+    }
+
+    /// Number of sentences.
+    #[must_use]
+    pub const fn sentence_count(&self) -> usize {
+        self.sentence_offsets.len() - 1
+    }
+
+    /// Number of words (rows of every column).
+    #[must_use]
+    pub const fn word_count(&self) -> usize {
+        self.heads.len()
+    }
+
+    /// First sentence of each document, followed by the end of the last one.
+    #[must_use]
+    pub fn document_offsets(&self) -> &[u32] {
+        &self.document_offsets
+    }
+
+    /// First word of each sentence, followed by the end of the last one.
+    #[must_use]
+    pub fn sentence_offsets(&self) -> &[u32] {
+        &self.sentence_offsets
+    }
+
+    /// The rows of the words of sentence `index`.
+    #[must_use]
+    pub fn sentence_words(&self, index: usize) -> Option<Range<usize>> {
+        let start = *self.sentence_offsets.get(index)? as usize;
+        let end = *self.sentence_offsets.get(index + 1)? as usize;
+        Some(start..end)
+    }
+
+    /// Word forms.
+    #[must_use]
+    pub const fn forms(&self) -> &StringColumn {
+        &self.forms
+    }
+
+    /// Lemmas.
+    #[must_use]
+    pub const fn lemmas(&self) -> &StringColumn {
+        &self.lemmas
+    }
+
+    /// Universal POS tag ids (see [`ColumnarBatch::upostag_vocab`]).
+    #[must_use]
+    pub fn upostags(&self) -> &[u8] {
+        &self.upostags
+    }
+
+    /// Values of [`ColumnarBatch::upostags`].
+    #[must_use]
+    pub const fn upostag_vocab(&self) -> &Vocabulary {
+        &self.upostag_vocab
+    }
+
+    /// Language-specific POS tag ids (see [`ColumnarBatch::xpostag_vocab`]).
+    #[must_use]
+    pub fn xpostags(&self) -> &[u16] {
+        &self.xpostags
+    }
+
+    /// Values of [`ColumnarBatch::xpostags`].
+    #[must_use]
+    pub const fn xpostag_vocab(&self) -> &Vocabulary {
+        &self.xpostag_vocab
+    }
+
+    /// Morphological feature set ids (see [`ColumnarBatch::feats_vocab`]).
+    #[must_use]
+    pub fn feats(&self) -> &[u16] {
+        &self.feats
+    }
+
+    /// Values of [`ColumnarBatch::feats`].
+    #[must_use]
+    pub const fn feats_vocab(&self) -> &Vocabulary {
+        &self.feats_vocab
+    }
+
+    /// Dependency relation ids (see [`ColumnarBatch::deprel_vocab`]).
+    #[must_use]
+    pub fn deprels(&self) -> &[u16] {
+        &self.deprels
+    }
+
+    /// Values of [`ColumnarBatch::deprels`].
+    #[must_use]
+    pub const fn deprel_vocab(&self) -> &Vocabulary {
+        &self.deprel_vocab
+    }
+
+    /// Head of each word: its 1-based index within the sentence, `0` for the
+    /// root, or `-1` if the sentence was not dependency parsed.
+    #[must_use]
+    pub fn heads(&self) -> &[i32] {
+        &self.heads
+    }
+}
+
+impl Model {
+    /// Parse many documents into one [`ColumnarBatch`].
+    ///
+    /// Sentences are read with [`Parser::next_ref`](crate::Parser::next_ref)
+    /// and written straight into the columns, so no per-word [`Word`](crate::Word)
+    /// is built. Document `i` of the batch is `texts[i]`.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if parsing any document fails, or if the batch
+    /// outgrows its column types (see [`ColumnarBatch::push`]).
+    pub fn parse_columnar<S: AsRef<str>>(&self, texts: &[S]) -> Result<ColumnarBatch, UdpipeError> {
+        self.parse_columnar_with_options(texts, ParseOptions::default())
+    }
+
+    /// Parse many documents into one [`ColumnarBatch`] with explicit
+    /// [`ParseOptions`].
+    ///
+    /// Columns left out of [`ParseOptions::fields`] hold empty strings.
+    ///
+    /// # Errors
+    ///
+    /// See [`Model::parse_columnar`].
+    pub fn parse_columnar_with_options<S: AsRef<str>>(
+        &self,
+        texts: &[S],
+        options: ParseOptions,
+    ) -> Result<ColumnarBatch, UdpipeError> {
+        let mut batch = ColumnarBatch::new();
+        for text in texts {
+            let mut parser = self.parser_with_options(text.as_ref(), options)?;
+            while let Some(sentence) = parser.next_ref() {
+                batch.push(&sentence?)?;
+            }
+            batch.finish_document();
+        }
+        Ok(batch)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// A word with the given form, tag and head; other fields derived.
+    pub(super) fn word(form: &'static str, upostag: &'static str, head: i32) -> WordRef<'static> {
+        WordRef {
+            form,
+            lemma: form,
+            upostag,
+            xpostag: "",
+            feats: "",
+            deprel: if head == 0 { "root" } else { "dep" },
+            deps: "",
+            misc: "",
+            id: 0,
+            head,
+            children: &[],
+            start: 0,
+            end: 0,
+        }
+    }
+
+    #[test]
+    fn test_columnar_batch_layout() {
+        let mut batch = ColumnarBatch::new();
+        batch
+            .push_words([word("Dogs", "NOUN", 2), word("bark", "VERB", 0)].into_iter())
+            .unwrap();
+        batch.finish_document();
+        batch
+            .push_words(std::iter::once(word("Cats", "NOUN", 0)))
+            .unwrap();
+        batch.push_words(std::iter::empty()).unwrap();
+        batch.finish_document();
+
+        assert_eq!(batch.document_count(), 2);
+        assert_eq!(batch.document_offsets(), [0, 1, 3]);
+        assert_eq!(batch.sentence_count(), 3);
+        assert_eq!(batch.sentence_offsets(), [0, 2, 3, 3]);
+        assert_eq!(batch.sentence_words(1), Some(2..3));
+        assert_eq!(batch.sentence_words(3), None);
+        assert_eq!(batch.word_count(), 3);
+
+        assert_eq!(batch.forms().data(), "DogsbarkCats");
+        assert_eq!(batch.forms().offsets(), [0, 4, 8, 12]);
+        assert_eq!(batch.forms().get(1), Some("bark"));
+        assert_eq!(
+            batch.lemmas().iter().collect::<Vec<_>>(),
+            ["Dogs", "bark", "Cats"]
+        );
+        assert_eq!(batch.upostags(), [0, 1, 0]);
+        assert_eq!(batch.upostag_vocab().values(), ["NOUN", "VERB"]);
+        assert_eq!(batch.upostag_vocab().id("VERB"), Some(1));
+        assert_eq!(
+            batch.deprel_vocab().get(u32::from(batch.deprels()[1])),
+            Some("root")
+        );
+        assert_eq!(batch.heads(), [2, 0, 0]);
+    }
+
+    #[test]
+    fn test_columnar_batch_overflow_leaves_batch_unchanged() {
+        let mut batch = ColumnarBatch::new();
+        let tags: Vec<String> = (0..256).map(|i| format!("T{i}")).collect();
+        batch
+            .push_words(tags.iter().map(|tag| WordRef {
+                upostag: tag,
+                ..word("w", "", 0)
+            }))
+            .unwrap();
+        assert_eq!(batch.upostag_vocab().len(), 256);
+        let before = batch.clone();
+
+        // The first word adds new values to other vocabularies before the
+        // second one overflows `upostag`.
+        let first = WordRef {
+            xpostag: "NEWX",
+            feats: "New=Yes",
+            ..word("a", "T0", 2)
+        };
+        let err = batch
+            .push_words([first, word("x", "NEW", 0)].into_iter())
+            .unwrap_err();
+        assert_eq!(err.kind, UdpipeErrorKind::InvalidInput);
+        assert_eq!(batch, before);
+        assert_eq!(batch.xpostag_vocab().id("NEWX"), None);
+        assert_eq!(batch.feats_vocab().id("New=Yes"), None);
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_parse_columnar_with_null_model() {
+        let model = Model {
+            inner: std::ptr::null_mut(),
+        };
+        assert_eq!(
+            model.parse_columnar::<&str>(&[]).unwrap(),
+            ColumnarBatch::new()
+        );
+        let err = model.parse_columnar(&["text"]).unwrap_err();
+        assert!(err.message.contains("Invalid arguments"));
+    }
+}
@@ -0,0 +1,231 @@
+//! Conversion of a [`ColumnarBatch`] to an Arrow [`RecordBatch`] (the `arrow`
+//! feature).
+
+use std::sync::Arc;
+
+use arrow_array::types::{UInt8Type, UInt16Type};
+use arrow_array::{
+    ArrayRef, DictionaryArray, Int32Array, RecordBatch, StringArray, UInt8Array, UInt16Array,
+    UInt32Array,
+};
+use arrow_buffer::{Buffer, OffsetBuffer, ScalarBuffer};
+use arrow_schema::{ArrowError, DataType, Field, Schema, SchemaRef};
+
+use super::{ColumnarBatch, StringColumn, Vocabulary, overflow};
+use crate::{UdpipeError, UdpipeErrorKind};
+
+/// An `InvalidInput` error caused by `err`.
+fn arrow_error(err: ArrowError) -> UdpipeError {
+    UdpipeError {
+        kind: UdpipeErrorKind::InvalidInput,
+        message: err.to_string(),
+        source: Some(Arc::new(err)),
+    }
+}
+
+/// A dictionary-encoded string type with keys of type `key`.
+fn dictionary(key: DataType) -> DataType {
+    DataType::Dictionary(Box::new(key), Box::new(DataType::Utf8))
+}
+
+impl StringColumn {
+    /// Move the column into an Arrow string array, reusing its bytes.
+    fn into_arrow(self) -> Result<StringArray, UdpipeError> {
+        let offsets = self
+            .offsets
+            .into_iter()
+            .map(i32::try_from)
+            .collect::<Result<Vec<_>, _>>()
+            .map_err(|_| overflow("string column is larger than 2 GiB"))?;
+        StringArray::try_new(
+            OffsetBuffer::new(ScalarBuffer::from(offsets)),
+            Buffer::from(self.data.into_bytes()),
+            None,
+        )
+        .map_err(arrow_error)
+    }
+}
+
+impl Vocabulary {
+    /// The values as the dictionary of an Arrow dictionary array.
+    fn into_arrow(self) -> ArrayRef {
+        Arc::new(StringArray::from_iter_values(self.values))
+    }
+}
+
+impl ColumnarBatch {
+    /// The schema of [`ColumnarBatch::into_record_batch`]: one row per word,
+    /// with columns
+    ///
+    /// | Column     | Type                         | Content                              |
+    /// |------------|------------------------------|--------------------------------------|
+    /// | `document` | `UInt32`                     | Index of the word's document         |
+    /// | `sentence` | `UInt32`                     | Index of the word's sentence         |
+    /// | `id`       | `UInt32`                     | 1-based index within the sentence    |
+    /// | `form`     | `Utf8`                       | [`ColumnarBatch::forms`]             |
+    /// | `lemma`    | `Utf8`                       | [`ColumnarBatch::lemmas`]            |
+    /// | `upos`     | `Dictionary(UInt8, Utf8)`    | [`ColumnarBatch::upostags`]          |
+    /// | `xpos`     | `Dictionary(UInt16, Utf8)`   | [`ColumnarBatch::xpostags`]          |
+    /// | `feats`    | `Dictionary(UInt16, Utf8)`   | [`ColumnarBatch::feats`]             |
+    /// | `deprel`   | `Dictionary(UInt16, Utf8)`   | [`ColumnarBatch::deprels`]           |
+    /// | `head`     | `Int32`                      | [`ColumnarBatch::heads`]             |
+    ///
+    /// No column is nullable. Sentences pushed after the last
+    /// [`ColumnarBatch::finish_document`] have document index
+    /// [`ColumnarBatch::document_count`].
+    #[must_use]
+    #[cfg_attr(docsrs, doc(cfg(feature = "arrow")))]
+    pub fn arrow_schema() -> SchemaRef {
+        Arc::new(Schema::new(vec![
+            Field::new("document", DataType::UInt32, false),
+            Field::new("sentence", DataType::UInt32, false),
+            Field::new("id", DataType::UInt32, false),
+            Field::new("form", DataType::Utf8, false),
+            Field::new("lemma", DataType::Utf8, false),
+            Field::new("upos", dictionary(DataType::UInt8), false),
+            Field::new("xpos", dictionary(DataType::UInt16), false),
+            Field::new("feats", dictionary(DataType::UInt16), false),
+            Field::new("deprel", dictionary(DataType::UInt16), false),
+            Field::new("head", DataType::Int32, false),
+        ]))
+    }
+
+    /// Convert the batch to an Arrow [`RecordBatch`] with the schema of
+    /// [`ColumnarBatch::arrow_schema`].
+    ///
+    /// The string data and interned ids are moved into the Arrow arrays
+    /// without copying: tag, feature and relation columns become dictionary
+    /// arrays whose keys are the batch's ids and whose dictionaries are its
+    /// [`Vocabulary`] values.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if a string column holds more than 2 GiB, the limit of
+    /// Arrow's `Utf8` type.
+    #[cfg_attr(docsrs, doc(cfg(feature = "arrow")))]
+    pub fn into_record_batch(self) -> Result<RecordBatch, UdpipeError> {
+        let (documents, sentences, ids) = self.row_indices();
+        let columns: Vec<ArrayRef> = vec![
+            Arc::new(UInt32Array::from(documents)),
+            Arc::new(UInt32Array::from(sentences)),
+            Arc::new(UInt32Array::from(ids)),
+            Arc::new(self.forms.into_arrow()?),
+            Arc::new(self.lemmas.into_arrow()?),
+            Arc::new(
+                DictionaryArray::<UInt8Type>::try_new(
+                    UInt8Array::from(self.upostags),
+                    self.upostag_vocab.into_arrow(),
+                )
+                .map_err(arrow_error)?,
+            ),
+            Arc::new(
+                DictionaryArray::<UInt16Type>::try_new(
+                    UInt16Array::from(self.xpostags),
+                    self.xpostag_vocab.into_arrow(),
+                )
+                .map_err(arrow_error)?,
+            ),
+            Arc::new(
+                DictionaryArray::<UInt16Type>::try_new(
+                    UInt16Array::from(self.feats),
+                    self.feats_vocab.into_arrow(),
+                )
+                .map_err(arrow_error)?,
+            ),
+            Arc::new(
+                DictionaryArray::<UInt16Type>::try_new(
+                    UInt16Array::from(self.deprels),
+                    self.deprel_vocab.into_arrow(),
+                )
+                .map_err(arrow_error)?,
+            ),
+            Arc::new(Int32Array::from(self.heads)),
+        ];
+        RecordBatch::try_new(Self::arrow_schema(), columns).map_err(arrow_error)
+    }
+
+    /// The document index, sentence index and 1-based id of every row.
+    fn row_indices(&self) -> (Vec<u32>, Vec<u32>, Vec<u32>) {
+        let rows = self.word_count();
+        let mut documents: Vec<u32> = Vec::with_capacity(rows);
+        let mut sentences: Vec<u32> = Vec::with_capacity(rows);
+        let mut ids: Vec<u32> = Vec::with_capacity(rows);
+        let mut document: u32 = 0;
+        for (sentence, bounds) in (0..).zip(self.sentence_offsets.windows(2)) {
+            while self
+                .document_offsets
+                .get(document as usize + 1)
+                .is_some_and(|&end| end <= sentence)
+            {
+                document += 1;
+            }
+            for id in 1..=bounds[1] - bounds[0] {
+                documents.push(document);
+                sentences.push(sentence);
+                ids.push(id);
+            }
+        }
+        (documents, sentences, ids)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use arrow_array::cast::AsArray;
+    use arrow_array::types::{Int32Type, UInt32Type};
+
+    use super::*;
+    use crate::columnar::tests::word;
+
+    #[test]
+    fn test_into_record_batch() {
+        let mut batch = ColumnarBatch::new();
+        batch
+            .push_words([word("Dogs", "NOUN", 2), word("bark", "VERB", 0)].into_iter())
+            .unwrap();
+        batch.finish_document();
+        batch.push_words(std::iter::empty()).unwrap();
+        batch.finish_document();
+        batch
+            .push_words(std::iter::once(word("Cats", "NOUN", 0)))
+            .unwrap();
+        batch.finish_document();
+
+        let record = batch.into_record_batch().unwrap();
+        assert_eq!(record.schema(), ColumnarBatch::arrow_schema());
+        assert_eq!(record.num_rows(), 3);
+
+        let column = |name| record.column_by_name(name).unwrap();
+        let documents = column("document").as_primitive::<UInt32Type>();
+        assert_eq!(documents.values(), [0, 0, 2]);
+        let sentences = column("sentence").as_primitive::<UInt32Type>();
+        assert_eq!(sentences.values(), [0, 0, 2]);
+        let ids = column("id").as_primitive::<UInt32Type>();
+        assert_eq!(ids.values(), [1, 2, 1]);
+        assert_eq!(column("form").as_string::<i32>().value(1), "bark");
+        assert_eq!(column("lemma").as_string::<i32>().value(2), "Cats");
+
+        let upos = column("upos").as_dictionary::<UInt8Type>();
+        assert_eq!(upos.keys().values(), [0, 1, 0]);
+        let upos_values = upos.values().as_string::<i32>();
+        assert_eq!(upos_values.value(0), "NOUN");
+        assert_eq!(upos_values.value(1), "VERB");
+        let deprel = column("deprel").as_dictionary::<UInt16Type>();
+        let deprel_values = deprel.values().as_string::<i32>();
+        assert_eq!(
+            deprel_values.value(usize::from(deprel.keys().value(1))),
+            "root"
+        );
+        assert_eq!(
+            column("head").as_primitive::<Int32Type>().values(),
+            [2, 0, 0]
+        );
+    }
+
+    #[test]
+    fn test_empty_batch_into_record_batch() {
+        let record = ColumnarBatch::new().into_record_batch().unwrap();
+        assert_eq!(record.num_rows(), 0);
+        assert_eq!(record.schema(), ColumnarBatch::arrow_schema());
+    }
+}
@@ -0,0 +1,608 @@
+//! Corpus-level parsing: many documents of very different sizes on a
+//! work-stealing pool, with large documents split at sentence boundaries.
+
+use std::collections::VecDeque;
+use std::sync::Mutex;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::mpsc::{self, Sender};
+use std::time::{Duration, Instant};
+
+use crate::{Model, ParseOptions, RawSentence, ReusableParser, Sentence, UdpipeError, lock};
+
+/// Default for [`CorpusOptions::split_bytes`].
+const DEFAULT_SPLIT_BYTES: usize = 64 << 10;
+
+/// Default for [`CorpusOptions::chunk_sentences`].
+const DEFAULT_CHUNK_SENTENCES: usize = 32;
+
+/// How long an idle worker sleeps after finding nothing to steal.
+const IDLE_SLEEP: Duration = Duration::from_micros(50);
+
+/// Options for [`Model::parse_corpus`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct CorpusOptions {
+    /// Number of worker threads. `0` uses
+    /// [`std::thread::available_parallelism`].
+    pub workers: usize,
+    /// Documents longer than this many bytes are split into chunks of
+    /// sentences that are tagged and parsed by any worker.
+    pub split_bytes: usize,
+    /// Number of sentences in each chunk of a split document. Values below 1
+    /// are treated as 1.
+    pub chunk_sentences: usize,
+    /// Options for the parser of each document.
+    pub parse: ParseOptions,
+}
+
+impl Default for CorpusOptions {
+    fn default() -> Self {
+        Self {
+            workers: 0,
+            split_bytes: DEFAULT_SPLIT_BYTES,
+            chunk_sentences: DEFAULT_CHUNK_SENTENCES,
+            parse: ParseOptions::default(),
+        }
+    }
+}
+
+impl CorpusOptions {
+    /// Set the number of worker threads (`0` = one per available core).
+    #[must_use]
+    pub const fn workers(mut self, workers: usize) -> Self {
+        self.workers = workers;
+        self
+    }
+
+    /// Set the size above which documents are split.
+    #[must_use]
+    pub const fn split_bytes(mut self, bytes: usize) -> Self {
+        self.split_bytes = bytes;
+        self
+    }
+
+    /// Set the number of sentences in each chunk of a split document.
+    #[must_use]
+    pub const fn chunk_sentences(mut self, sentences: usize) -> Self {
+        self.chunk_sentences = sentences;
+        self
+    }
+
+    /// Set the options for the parser of each document.
+    #[must_use]
+    pub const fn parse_options(mut self, parse: ParseOptions) -> Self {
+        self.parse = parse;
+        self
+    }
+}
+
+/// What one worker of [`Model::parse_corpus`] did, to spot load imbalance.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct WorkerStats {
+    /// Jobs run: whole documents, tokenization of split documents, and
+    /// chunks.
+    pub jobs: u64,
+    /// Jobs taken from another worker's queue.
+    pub stolen: u64,
+    /// Sentences tagged and parsed.
+    pub sentences: u64,
+    /// Words in those sentences.
+    pub words: u64,
+    /// Time spent running jobs (the rest was spent looking for work).
+    pub busy: Duration,
+}
+
+impl WorkerStats {
+    /// Words per second of busy time (`0` if the worker was never busy).
+    #[must_use]
+    pub fn words_per_second(&self) -> u64 {
+        (u128::from(self.words) * 1_000_000_000)
+            .checked_div(self.busy.as_nanos())
+            .map_or(0, |rate| u64::try_from(rate).unwrap_or(u64::MAX))
+    }
+}
+
+/// The result of [`Model::parse_corpus`].
+#[derive(Debug, Clone)]
+pub struct CorpusOutput {
+    /// The sentences of each document, in input order; a failing document
+    /// does not affect the others.
+    pub documents: Vec<Result<Vec<Sentence>, UdpipeError>>,
+    /// What each worker did.
+    pub workers: Vec<WorkerStats>,
+}
+
+/// A unit of work.
+enum Job<'t> {
+    /// Parse a whole document.
+    Document {
+        /// Position of the document in the input.
+        index: usize,
+        /// The document.
+        text: &'t str,
+    },
+    /// Tokenize a large document, queueing its sentences as chunks.
+    Split {
+        /// Position of the document in the input.
+        index: usize,
+        /// The document.
+        text: &'t str,
+    },
+    /// Tag and parse a chunk of a split document.
+    Chunk {
+        /// Position of the document in the input.
+        index: usize,
+        /// Position of the chunk in the document.
+        chunk: usize,
+        /// The tokenized sentences.
+        sentences: Vec<RawSentence>,
+    },
+}
+
+/// A result sent back to [`Model::parse_corpus`].
+enum Message {
+    /// The sentences of chunk `chunk` of document `index` (a whole document
+    /// is chunk 0).
+    Chunk {
+        /// Position of the document in the input.
+        index: usize,
+        /// Position of the chunk in the document.
+        chunk: usize,
+        /// The sentences, or the first error.
+        result: Result<Vec<Sentence>, UdpipeError>,
+    },
+    /// Document `index` was split into `chunks` chunks, and tokenizing it
+    /// ended with `result`.
+    Split {
+        /// Position of the document in the input.
+        index: usize,
+        /// Number of chunks queued.
+        chunks: usize,
+        /// Error from the tokenizer, if any.
+        result: Result<(), UdpipeError>,
+    },
+}
+
+/// The per-worker job queues and the count of unfinished jobs.
+struct Queues<'t> {
+    /// One double-ended queue per worker. The owner takes jobs from the
+    /// front, largest document first; thieves take from the back, where the
+    /// owner adds the chunks of documents it splits.
+    deques: Vec<Mutex<VecDeque<Job<'t>>>>,
+    /// Jobs queued or running. Workers stop once it drops to zero.
+    unfinished: AtomicUsize,
+}
+
+impl<'t> Queues<'t> {
+    /// Queue `job` on worker `owner`'s deque.
+    fn push(&self, owner: usize, job: Job<'t>) {
+        self.unfinished.fetch_add(1, Ordering::SeqCst);
+        lock(&self.deques[owner]).push_back(job);
+    }
+
+    /// Take a job for worker `me`: the front of its own deque, else the back
+    /// of another worker's. Returns the job and whether it was stolen.
+    fn take(&self, me: usize) -> Option<(Job<'t>, bool)> {
+        let own = lock(&self.deques[me]).pop_front();
+        if let Some(job) = own {
+            return Some((job, false));
+        }
+        let count = self.deques.len();
+        (1..count)
+            .map(|offset| (me + offset) % count)
+            .find_map(|victim| lock(&self.deques[victim]).pop_back())
+            .map(|job| (job, true))
+    }
+}
+
+/// Counts a taken job as finished when dropped, even if running it panicked,
+/// so that the other workers do not wait for it forever.
+struct Finished<'q>(&'q AtomicUsize);
+
+impl Drop for Finished<'_> {
+    fn drop(&mut self) {
+        self.0.fetch_sub(1, Ordering::SeqCst);
+    }
+}
+
+/// One worker of [`Model::parse_corpus`].
+struct Worker<'m, 't> {
+    /// Position of this worker, which owns `queues.deques[me]`.
+    me: usize,
+    /// The shared model.
+    model: &'m Model,
+    /// Tokenizer (and full pipeline for whole documents) of this worker.
+    parser: ReusableParser<'m>,
+    /// Shared job queues.
+    queues: &'t Queues<'t>,
+    /// Where results go.
+    results: Sender<Message>,
+    /// See [`CorpusOptions::chunk_sentences`] (at least 1).
+    chunk_sentences: usize,
+    /// What this worker did.
+    stats: WorkerStats,
+}
+
+impl<'t> Worker<'_, 't> {
+    /// Run jobs until none are left anywhere.
+    fn run(mut self) -> WorkerStats {
+        loop {
+            let Some((job, stolen)) = self.queues.take(self.me) else {
+                if self.queues.unfinished.load(Ordering::SeqCst) == 0 {
+                    return self.stats;
+                }
+                std::thread::sleep(IDLE_SLEEP);
+                continue;
+            };
+            let _finished = Finished(&self.queues.unfinished);
+            let start = Instant::now();
+            self.stats.jobs += 1;
+            self.stats.stolen += u64::from(stolen);
+            let message = self.run_job(job);
+            self.stats.busy += start.elapsed();
+            // The receiver outlives the workers.
+            drop(self.results.send(message));
+        }
+    }
+
+    /// Run one job and return its result.
+    fn run_job(&mut self, job: Job<'t>) -> Message {
+        match job {
+            Job::Document { index, text } => {
+                let result = self.parser.parse(text).and_then(Iterator::collect);
+                self.count(&result);
+                Message::Chunk {
+                    index,
+                    chunk: 0,
+                    result,
+                }
+            }
+            Job::Split { index, text } => {
+                let mut chunks = 0;
+                let mut sentences = Vec::with_capacity(self.chunk_sentences);
+                let result = self.parser.parse(text).and_then(|mut document| {
+                    while let Some(raw) = document.next_raw() {
+                        sentences.push(raw?);
+                        if sentences.len() == self.chunk_sentences {
+                            let chunk = std::mem::take(&mut sentences);
+                            self.queues.push(
+                                self.me,
+                                Job::Chunk {
+                                    index,
+                                    chunk: chunks,
+                                    sentences: chunk,
+                                },
+                            );
+                            chunks += 1;
+                        }
+                    }
+                    Ok(())
+                });
+                if !sentences.is_empty() {
+                    self.queues.push(
+                        self.me,
+                        Job::Chunk {
+                            index,
+                            chunk: chunks,
+                            sentences,
+                        },
+                    );
+                    chunks += 1;
+                }
+                Message::Split {
+                    index,
+                    chunks,
+                    result,
+                }
+            }
+            Job::Chunk {
+                index,
+                chunk,
+                sentences,
+            } => {
+                let result = sentences
+                    .into_iter()
+                    .map(|raw| raw.process(self.model))
+                    .collect();
+                self.count(&result);
+                Message::Chunk {
+                    index,
+                    chunk,
+                    result,
+                }
+            }
+        }
+    }
+
+    /// Add the sentences and words of `result` to the stats.
+    fn count(&mut self, result: &Result<Vec<Sentence>, UdpipeError>) {
+        if let Ok(sentences) = result {
+            self.stats.sentences += sentences.len() as u64;
+            self.stats.words += sentences
+                .iter()
+                .map(|sentence| sentence.words.len() as u64)
+                .sum::<u64>();
+        }
+    }
+}
+
+/// The chunks of one document collected so far.
+#[derive(Default)]
+struct Pieces {
+    /// Result of each chunk received, by position.
+    chunks: Vec<Option<Result<Vec<Sentence>, UdpipeError>>>,
+    /// The tokenizer's result, for a split document.
+    split: Option<Result<(), UdpipeError>>,
+}
+
+impl Pieces {
+    /// Record `message`.
+    fn add(&mut self, message: Message) {
+        match message {
+            Message::Chunk { chunk, result, .. } => {
+                if self.chunks.len() <= chunk {
+                    self.chunks.resize_with(chunk + 1, || None);
+                }
+                self.chunks[chunk] = Some(result);
+            }
+            Message::Split { chunks, result, .. } => {
+                if self.chunks.len() < chunks {
+                    self.chunks.resize_with(chunks, || None);
+                }
+                self.split = Some(result);
+            }
+        }
+    }
+
+    /// Join the chunks in order; the first error, if any, wins.
+    fn assemble(self) -> Result<Vec<Sentence>, UdpipeError> {
+        let mut sentences = Vec::new();
+        for chunk in self.chunks.into_iter().flatten() {
+            sentences.extend(chunk?);
+        }
+        self.split.unwrap_or(Ok(()))?;
+        Ok(sentences)
+    }
+}
+
+impl Model {
+    /// Parse a corpus of documents on a work-stealing pool of threads sharing
+    /// this model.
+    ///
+    /// Documents are dealt to the workers largest first. Each worker runs its
+    /// own jobs in that order and, when it runs out, steals from the back of
+    /// another worker's queue. Documents longer than [`CorpusOptions::split_bytes`]
+    /// are tokenized by one worker, which queues their sentences in chunks of
+    /// [`CorpusOptions::chunk_sentences`] as it goes. Other workers then steal
+    /// and tag and parse those chunks, so one huge file no longer leaves the
+    /// other cores idle at the end of the run. Splitting happens only at the
+    /// tokenizer's sentence boundaries, so results are the same as parsing
+    /// each document whole.
+    ///
+    /// The returned [`CorpusOutput`] has the sentences of each document in
+    /// input order, and [`WorkerStats`] for each worker to show imbalance.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if the workers' parsers cannot be created. Errors in
+    /// individual documents are reported in [`CorpusOutput::documents`].
+    ///
+    /// # Panics
+    ///
+    /// If a worker panics, the panic is resumed on the calling thread once the
+    /// other workers have run the remaining jobs.
+    ///
+    /// # Example
+    /// ```no_run
+    /// use udpipe_rs::{CorpusOptions, Model};
+    ///
+    /// let model = Model::load("english-ewt-ud-2.5-191206.udpipe").expect("Failed to load");
+    /// let texts = ["A short file.", "A much longer file. With many sentences."];
+    /// let output = model
+    ///     .parse_corpus(&texts, CorpusOptions::default())
+    ///     .expect("Failed to start workers");
+    /// for (worker, stats) in output.workers.iter().enumerate() {
+    ///     println!("worker {worker}: {} words/s", stats.words_per_second());
+    /// }
+    /// ```
+    pub fn parse_corpus<S>(
+        &self,
+        texts: &[S],
+        options: CorpusOptions,
+    ) -> Result<CorpusOutput, UdpipeError>
+    where
+        S: AsRef<str> + Sync,
+    {
+        let workers = if options.workers == 0 {
+            std::thread::available_parallelism().map_or(1, std::num::NonZeroUsize::get)
+        } else {
+            options.workers
+        };
+        let parsers = (0..workers)
+            .map(|_| self.reusable_parser_with_options(options.parse))
+            .collect::<Result<Vec<_>, _>>()?;
+
+        let queues = Queues {
+            deques: (0..workers).map(|_| Mutex::default()).collect(),
+            unfinished: AtomicUsize::new(0),
+        };
+        let mut order: Vec<usize> = (0..texts.len()).collect();
+        order.sort_by_key(|&index| std::cmp::Reverse(texts[index].as_ref().len()));
+        for (position, index) in order.into_iter().enumerate() {
+            let text = texts[index].as_ref();
+            let job = if text.len() > options.split_bytes {
+                Job::Split { index, text }
+            } else {
+                Job::Document { index, text }
+            };
+            queues.push(position % workers, job);
+        }
+
+        let (results, messages) = mpsc::channel();
+        let stats = std::thread::scope(|s| {
+            let handles: Vec<_> = parsers
+                .into_iter()
+                .enumerate()
+                .map(|(me, parser)| {
+                    let worker = Worker {
+                        me,
+                        model: self,
+                        parser,
+                        queues: &queues,
+                        results: results.clone(),
+                        chunk_sentences: options.chunk_sentences.max(1),
+                        stats: WorkerStats::default(),
+                    };
+                    s.spawn(move || worker.run())
+                })
+                .collect();
+            handles
+                .into_iter()
+                .map(|handle| {
+                    handle
+                        .join()
+                        .unwrap_or_else(|panic| std::panic::resume_unwind(panic))
+                })
+                .collect()
+        });
+        drop(results);
+
+        let mut pieces: Vec<Pieces> = std::iter::repeat_with(Pieces::default)
+            .take(texts.len())
+            .collect();
+        for message in messages {
+            let (Message::Chunk { index, .. } | Message::Split { index, .. }) = message;
+            pieces[index].add(message);
+        }
+        let mut documents = Vec::with_capacity(texts.len());
+        for document in pieces {
+            documents.push(document.assemble());
+        }
+        Ok(CorpusOutput {
+            documents,
+            workers: stats,
+        })
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// A sentence identified by its comment.
+    fn sentence(comment: &str) -> Sentence {
+        Sentence {
+            words: Vec::new(),
+            multiword_tokens: Vec::new(),
+            comments: vec![comment.to_owned()],
+        }
+    }
+
+    #[test]
+    fn test_corpus_options_builder() {
+        let options = CorpusOptions::default()
+            .workers(3)
+            .split_bytes(10)
+            .chunk_sentences(4);
+        assert_eq!(options.workers, 3);
+        assert_eq!(options.split_bytes, 10);
+        assert_eq!(options.chunk_sentences, 4);
+        assert_eq!(CorpusOptions::default().split_bytes, DEFAULT_SPLIT_BYTES);
+    }
+
+    #[test]
+    fn test_pieces_assemble_in_chunk_order() {
+        let mut pieces = Pieces::default();
+        for (chunk, comment) in [(1, "b"), (0, "a"), (2, "c")] {
+            pieces.add(Message::Chunk {
+                index: 0,
+                chunk,
+                result: Ok(vec![sentence(comment)]),
+            });
+        }
+        pieces.add(Message::Split {
+            index: 0,
+            chunks: 3,
+            result: Ok(()),
+        });
+        let comments: Vec<_> = pieces
+            .assemble()
+            .unwrap()
+            .into_iter()
+            .map(|s| s.comments[0].clone())
+            .collect();
+        assert_eq!(comments, ["a", "b", "c"]);
+    }
+
+    #[test]
+    fn test_pieces_report_tokenizer_error() {
+        let mut pieces = Pieces::default();
+        pieces.add(Message::Split {
+            index: 0,
+            chunks: 1,
+            result: Err(UdpipeError::new(
+                crate::UdpipeErrorKind::ParseError,
+                "tokenizer failed",
+            )),
+        });
+        pieces.add(Message::Chunk {
+            index: 0,
+            chunk: 0,
+            result: Ok(vec![sentence("a")]),
+        });
+        assert_eq!(pieces.assemble().unwrap_err().message, "tokenizer failed");
+    }
+
+    #[test]
+    fn test_panicking_job_is_finished() {
+        let unfinished = AtomicUsize::new(2);
+        let panicked = std::panic::catch_unwind(|| {
+            let _finished = Finished(&unfinished);
+            panic!("job failed");
+        });
+        assert!(panicked.is_err());
+        assert_eq!(unfinished.load(Ordering::SeqCst), 1);
+    }
+
+    #[test]
+    fn test_queues_owner_takes_front_thief_takes_back() {
+        let queues = Queues {
+            deques: (0..2).map(|_| Mutex::default()).collect(),
+            unfinished: AtomicUsize::new(0),
+        };
+        for index in 0..3 {
+            queues.push(0, Job::Document { index, text: "" });
+        }
+        assert_eq!(queues.unfinished.load(Ordering::SeqCst), 3);
+        let Some((Job::Document { index, .. }, true)) = queues.take(1) else {
+            panic!("expected a stolen document");
+        };
+        assert_eq!(index, 2);
+        let Some((Job::Document { index, .. }, false)) = queues.take(0) else {
+            panic!("expected an own document");
+        };
+        assert_eq!(index, 0);
+    }
+
+    #[test]
+    fn test_worker_stats_words_per_second() {
+        let stats = WorkerStats {
+            words: 500,
+            busy: Duration::from_millis(250),
+            ..WorkerStats::default()
+        };
+        assert_eq!(stats.words_per_second(), 2000);
+        assert_eq!(WorkerStats::default().words_per_second(), 0);
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_parse_corpus_with_null_model() {
+        let model = Model {
+            inner: std::ptr::null_mut(),
+        };
+        let err = model
+            .parse_corpus(&["text"], CorpusOptions::default().workers(2))
+            .unwrap_err();
+        assert!(err.message.contains("Invalid arguments"));
+    }
+}
@@ -29,12 +29,44 @@ use std::fs::File;
 #[cfg(feature = "download")]
 use std::io::BufWriter;
 use std::path::Path;
+use std::time::Instant;
+
+mod batch;
+mod columnar;
+mod corpus;
+mod options;
+mod parallel;
+mod pipeline;
+mod reader;
+mod replicated;
+mod reusable;
+mod scheduler;
+#[cfg(feature = "async")]
+mod service;
+mod stats;
+mod tokens;
+
+pub use batch::BatchOptions;
+pub use columnar::{ColumnarBatch, StringColumn, Vocabulary};
+pub use corpus::{CorpusOptions, CorpusOutput, WorkerStats};
+pub use options::{Fields, ParseOptions, Stages};
+pub use parallel::{ParallelOptions, ParallelParser};
+pub use pipeline::{PipelineOptions, PipelinedParser};
+pub use reader::{ReaderOptions, ReaderParser};
+pub use replicated::ReplicatedModel;
+pub use reusable::{Document, ReusableParser};
+pub use scheduler::{MicroBatchOptions, MicroBatchStats, MicroBatcher};
+#[cfg(feature = "async")]
+#[cfg_attr(docsrs, doc(cfg(feature = "async")))]
+pub use service::{AsyncOptions, BatchFuture, ParseService, SentenceStream};
+pub use stats::ParseStats;
+use stats::elapsed_ns;
 
 /// Error kind for `UDPipe` operations.
 #[derive(Debug, Clone, PartialEq, Eq)]
 #[non_exhaustive]
 pub enum UdpipeErrorKind {
-    /// Text or path contained a null byte.
+    /// A model path contained a null byte.
     NullByteInText,
     /// Model file could not be loaded (invalid path or corrupt data).
     ModelLoadFailed,
@@ -46,6 +78,8 @@ pub enum UdpipeErrorKind {
     InvalidInput,
     /// Download failed (network error, empty response, or write failure).
     DownloadFailed,
+    /// Reading input text failed (I/O error or invalid UTF-8).
+    ReadFailed,
 }
 
 /// Error type for `UDPipe` operations.
@@ -99,7 +133,12 @@ impl From<std::io::Error> for UdpipeError {
 ///
 /// Note: The virtual root word (index 0 in `UDPipe`'s internal representation)
 /// is excluded from results. Word IDs are 1-based as per CoNLL-U format.
+///
+/// Words are produced by parsers only, and fields may be added in minor
+/// releases, so `Word` cannot be built with a struct literal outside this
+/// crate.
 #[derive(Debug, Clone, PartialEq, Eq)]
+#[non_exhaustive]
 pub struct Word {
     /// The surface form (actual text).
     pub form: String,
@@ -119,10 +158,19 @@ pub struct Word {
     pub misc: String,
     /// 1-based index of this word within its sentence.
     pub id: i32,
-    /// Index of the head word (0 = root).
+    /// Index of the head word (0 = root; -1 if the sentence was not
+    /// dependency parsed, see [`Stages`]).
     pub head: i32,
     /// Indices of child words in the dependency tree.
     pub children: Vec<i32>,
+    /// Byte offset of this word's token in the parsed text, so that
+    /// `&text[word.start..word.end]` is its surface text. Words of a multiword
+    /// token share its range. Both are `0` unless requested with
+    /// [`ParseOptions::offsets`].
+    pub start: usize,
+    /// Byte offset just past the end of this word's token (see
+    /// [`Word::start`]).
+    pub end: usize,
 }
 
 /// A multiword token representing contractions (e.g., "don't" -> "do" + "n't").
@@ -154,6 +202,278 @@ pub struct Sentence {
     pub comments: Vec<String>,
 }
 
+/// A borrowed view of a [`Word`] whose fields point into the parser's buffers.
+///
+/// Obtained from [`SentenceRef::words`]. No allocation is performed; use
+/// [`WordRef::to_word`] to produce an owned [`Word`] when needed.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[non_exhaustive]
+pub struct WordRef<'s> {
+    /// The surface form (actual text).
+    pub form: &'s str,
+    /// The lemma (dictionary form).
+    pub lemma: &'s str,
+    /// Universal POS tag (NOUN, VERB, ADJ, etc.).
+    pub upostag: &'s str,
+    /// Language-specific POS tag.
+    pub xpostag: &'s str,
+    /// Morphological features (e.g., "VerbForm=Inf|Mood=Imp").
+    pub feats: &'s str,
+    /// Dependency relation to head (root, nsubj, obj, etc.).
+    pub deprel: &'s str,
+    /// Enhanced dependencies (graph-based).
+    pub deps: &'s str,
+    /// Miscellaneous annotations (e.g., "SpaceAfter=No").
+    pub misc: &'s str,
+    /// 1-based index of this word within its sentence.
+    pub id: i32,
+    /// Index of the head word (0 = root).
+    pub head: i32,
+    /// Indices of child words in the dependency tree.
+    pub children: &'s [i32],
+    /// Byte offset of this word's token in the parsed text (see
+    /// [`Word::start`]).
+    pub start: usize,
+    /// Byte offset just past the end of this word's token.
+    pub end: usize,
+}
+
+impl WordRef<'_> {
+    /// Copy this view into an owned [`Word`].
+    #[must_use]
+    pub fn to_word(&self) -> Word {
+        Word {
+            form: self.form.to_owned(),
+            lemma: self.lemma.to_owned(),
+            upostag: self.upostag.to_owned(),
+            xpostag: self.xpostag.to_owned(),
+            feats: self.feats.to_owned(),
+            deprel: self.deprel.to_owned(),
+            deps: self.deps.to_owned(),
+            misc: self.misc.to_owned(),
+            id: self.id,
+            head: self.head,
+            children: self.children.to_vec(),
+            start: self.start,
+            end: self.end,
+        }
+    }
+}
+
+/// A borrowed view of a [`MultiwordToken`].
+///
+/// Obtained from [`SentenceRef::multiword_tokens`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[non_exhaustive]
+pub struct MultiwordTokenRef<'s> {
+    /// The surface form of the multiword token.
+    pub form: &'s str,
+    /// Miscellaneous annotations.
+    pub misc: &'s str,
+    /// First word ID in the token range (inclusive).
+    pub id_first: i32,
+    /// Last word ID in the token range (inclusive).
+    pub id_last: i32,
+}
+
+impl MultiwordTokenRef<'_> {
+    /// Copy this view into an owned [`MultiwordToken`].
+    #[must_use]
+    pub fn to_multiword_token(&self) -> MultiwordToken {
+        MultiwordToken {
+            form: self.form.to_owned(),
+            misc: self.misc.to_owned(),
+            id_first: self.id_first,
+            id_last: self.id_last,
+        }
+    }
+}
+
+/// A borrowed view of a parsed sentence, yielded by [`Parser::next_ref`].
+///
+/// The string fields of the [`WordRef`]s and [`MultiwordTokenRef`]s it hands
+/// out point directly into the C++ sentence buffers, so reading a sentence
+/// this way performs no per-field allocation. The view borrows the parser
+/// mutably and is invalidated by the next call to [`Parser::next_ref`]; call
+/// [`SentenceRef::to_sentence`] to keep an owned copy.
+///
+/// Fields that are not valid UTF-8 (which `UDPipe` does not produce for UTF-8
+/// input) are exposed as `"\u{FFFD}"`; [`SentenceRef::to_sentence`] instead
+/// replaces only the invalid sequences.
+pub struct SentenceRef<'p> {
+    /// Raw pointer to the C++ sentence (owned and reused by the parser).
+    inner: *mut ffi::UdpipeSentence,
+    /// Ties the view to the mutable borrow of the parser that produced it.
+    _parser: std::marker::PhantomData<&'p mut ()>,
+}
+
+impl std::fmt::Debug for SentenceRef<'_> {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("SentenceRef")
+            .field("words", &self.words().collect::<Vec<_>>())
+            .field(
+                "multiword_tokens",
+                &self.multiword_tokens().collect::<Vec<_>>(),
+            )
+            .field("comments", &self.comments().collect::<Vec<_>>())
+            .finish()
+    }
+}
+
+impl SentenceRef<'_> {
+    /// Number of words in this sentence (excluding the virtual root).
+    #[must_use]
+    pub fn word_count(&self) -> usize {
+        // SAFETY: `self.inner` is a sentence from `udpipe_parser_next` (or null, which
+        // the C++ side handles).
+        let count = unsafe { ffi::udpipe_sentence_word_count(self.inner) };
+        usize::try_from(count).unwrap_or(0)
+    }
+
+    /// The word at `index` (0-based; the word's `id` is `index + 1`).
+    #[must_use]
+    pub fn word(&self, index: usize) -> Option<WordRef<'_>> {
+        if index >= self.word_count() {
+            return None;
+        }
+        Some(self.get_word(index))
+    }
+
+    /// The raw view of the word at `index` and its children; out-of-range
+    /// indices yield empty fields.
+    fn raw_word(&self, index: usize) -> (ffi::UdpipeWordView, &[i32]) {
+        let index = i32::try_from(index).unwrap_or(-1);
+        // SAFETY: `self.inner` is valid; the C++ side bounds-checks `index`.
+        let w = unsafe { ffi::udpipe_sentence_get_word_view(self.inner, index) };
+        let children = if w.children.is_null() || w.children_count <= 0 {
+            &[]
+        } else {
+            let count = usize::try_from(w.children_count).unwrap_or(0);
+            // SAFETY: w.children is valid for w.children_count elements while the sentence
+            // lives, which the borrow of `self` guarantees.
+            unsafe { std::slice::from_raw_parts(w.children, count) }
+        };
+        (w, children)
+    }
+
+    /// Read the word at `index`; out-of-range indices yield empty fields.
+    fn get_word(&self, index: usize) -> WordRef<'_> {
+        let (w, children) = self.raw_word(index);
+        WordRef {
+            form: view_to_str(w.form),
+            lemma: view_to_str(w.lemma),
+            upostag: view_to_str(w.upostag),
+            xpostag: view_to_str(w.xpostag),
+            feats: view_to_str(w.feats),
+            deprel: view_to_str(w.deprel),
+            deps: view_to_str(w.deps),
+            misc: view_to_str(w.misc),
+            id: w.id,
+            head: w.head,
+            children,
+            start: w.start,
+            end: w.end,
+        }
+    }
+
+    /// Iterate over the words in this sentence.
+    #[must_use]
+    pub fn words(&self) -> impl ExactSizeIterator<Item = WordRef<'_>> {
+        (0..self.word_count()).map(|i| self.get_word(i))
+    }
+
+    /// Number of multiword tokens in this sentence.
+    #[must_use]
+    pub fn multiword_token_count(&self) -> usize {
+        // SAFETY: `self.inner` is a sentence from `udpipe_parser_next` (or null).
+        let count = unsafe { ffi::udpipe_sentence_multiword_token_count(self.inner) };
+        usize::try_from(count).unwrap_or(0)
+    }
+
+    /// Iterate over the multiword tokens in this sentence.
+    #[must_use]
+    pub fn multiword_tokens(&self) -> impl ExactSizeIterator<Item = MultiwordTokenRef<'_>> {
+        (0..self.multiword_token_count()).map(|i| {
+            let mwt = self.raw_multiword_token(i);
+            MultiwordTokenRef {
+                form: view_to_str(mwt.form),
+                misc: view_to_str(mwt.misc),
+                id_first: mwt.id_first,
+                id_last: mwt.id_last,
+            }
+        })
+    }
+
+    /// The raw view of the multiword token at `index`.
+    fn raw_multiword_token(&self, index: usize) -> ffi::UdpipeMultiwordTokenView {
+        // SAFETY: `self.inner` is valid; the C++ side bounds-checks `index`.
+        unsafe {
+            ffi::udpipe_sentence_get_multiword_token_view(
+                self.inner,
+                i32::try_from(index).unwrap_or(-1),
+            )
+        }
+    }
+
+    /// Iterate over the CoNLL-U comments of this sentence.
+    #[must_use]
+    pub fn comments(&self) -> impl ExactSizeIterator<Item = &str> {
+        self.raw_comments().map(view_to_str)
+    }
+
+    /// Iterate over the raw views of the comments of this sentence.
+    fn raw_comments(&self) -> impl ExactSizeIterator<Item = ffi::UdpipeStr> {
+        // SAFETY: `self.inner` is a sentence from `udpipe_parser_next` (or null).
+        let count = unsafe { ffi::udpipe_sentence_comment_count(self.inner) };
+        (0..count.max(0)).map(|i| {
+            // SAFETY: `self.inner` is valid and `i` is in range.
+            unsafe { ffi::udpipe_sentence_get_comment_view(self.inner, i) }
+        })
+    }
+
+    /// Copy this view into an owned [`Sentence`].
+    ///
+    /// Unlike the borrowed fields, a field that is not valid UTF-8 keeps its
+    /// valid parts, with each invalid sequence replaced by `"\u{FFFD}"`.
+    #[must_use]
+    pub fn to_sentence(&self) -> Sentence {
+        let mut words = Vec::with_capacity(self.word_count());
+        for index in 0..self.word_count() {
+            let (w, children) = self.raw_word(index);
+            words.push(Word {
+                form: view_to_string(w.form),
+                lemma: view_to_string(w.lemma),
+                upostag: view_to_string(w.upostag),
+                xpostag: view_to_string(w.xpostag),
+                feats: view_to_string(w.feats),
+                deprel: view_to_string(w.deprel),
+                deps: view_to_string(w.deps),
+                misc: view_to_string(w.misc),
+                id: w.id,
+                head: w.head,
+                children: children.to_vec(),
+                start: w.start,
+                end: w.end,
+            });
+        }
+        let mut multiword_tokens = Vec::with_capacity(self.multiword_token_count());
+        for index in 0..self.multiword_token_count() {
+            let mwt = self.raw_multiword_token(index);
+            multiword_tokens.push(MultiwordToken {
+                form: view_to_string(mwt.form),
+                misc: view_to_string(mwt.misc),
+                id_first: mwt.id_first,
+                id_last: mwt.id_last,
+            });
+        }
+        Sentence {
+            words,
+            multiword_tokens,
+            comments: self.raw_comments().map(view_to_string).collect(),
+        }
+    }
+}
+
 /// FFI declarations for the `UDPipe` C++ wrapper.
 mod ffi {
     use std::os::raw::c_char;
@@ -179,7 +499,16 @@ mod ffi {
         _private: [u8; 0],
     }
 
-    /// A single word from a sentence.
+    /// Opaque handle to a tokenized sentence detached from its parser.
+    #[repr(C)]
+    pub struct UdpipeRawSentence {
+        /// Zero-sized field to make this type opaque.
+        _private: [u8; 0],
+    }
+
+    /// A single word from a sentence (NUL-terminated strings; the crate reads
+    /// [`UdpipeWordView`] instead).
+    #[cfg(test)]
     #[repr(C)]
     pub struct UdpipeWord {
         /// Word form (the actual text).
@@ -206,9 +535,139 @@ mod ffi {
         pub head: i32,
         /// Number of children.
         pub children_count: i32,
+        /// Byte offset of the token in the parser's text.
+        pub start: usize,
+        /// Byte offset just past the token.
+        pub end: usize,
+    }
+
+    /// Tokenize only.
+    pub const UDPIPE_STAGE_TOKENIZE: i32 = 0;
+    /// Tokenize and tag.
+    pub const UDPIPE_STAGE_TAG: i32 = 1;
+    /// Tokenize, tag and parse.
+    pub const UDPIPE_STAGE_PARSE: i32 = 2;
+
+    /// Word form column.
+    pub const UDPIPE_FIELD_FORM: u32 = 1 << 0;
+    /// Lemma column.
+    pub const UDPIPE_FIELD_LEMMA: u32 = 1 << 1;
+    /// Universal POS tag column.
+    pub const UDPIPE_FIELD_UPOSTAG: u32 = 1 << 2;
+    /// Language-specific POS tag column.
+    pub const UDPIPE_FIELD_XPOSTAG: u32 = 1 << 3;
+    /// Morphological features column.
+    pub const UDPIPE_FIELD_FEATS: u32 = 1 << 4;
+    /// Dependency relation column.
+    pub const UDPIPE_FIELD_DEPREL: u32 = 1 << 5;
+    /// Enhanced dependencies column.
+    pub const UDPIPE_FIELD_DEPS: u32 = 1 << 6;
+    /// Miscellaneous annotations column.
+    pub const UDPIPE_FIELD_MISC: u32 = 1 << 7;
+    /// Children of each word.
+    pub const UDPIPE_FIELD_CHILDREN: u32 = 1 << 8;
+    /// Multiword tokens of each sentence.
+    pub const UDPIPE_FIELD_MULTIWORD_TOKENS: u32 = 1 << 9;
+    /// Comments of each sentence.
+    pub const UDPIPE_FIELD_COMMENTS: u32 = 1 << 10;
+    /// Every column.
+    pub const UDPIPE_FIELD_ALL: u32 = (1 << 11) - 1;
+
+    /// Input has one sentence per line.
+    pub const UDPIPE_TOKENIZER_PRESEGMENTED: u32 = 1 << 0;
+    /// Report the byte range of each word.
+    pub const UDPIPE_TOKENIZER_RANGES: u32 = 1 << 1;
+
+    /// Options for `udpipe_parser_new_with_options`.
+    #[repr(C)]
+    pub struct UdpipeParseOptions {
+        /// Last stage to run (`UDPIPE_STAGE_*`).
+        pub stages: i32,
+        /// Columns to copy (`UDPIPE_FIELD_*` mask).
+        pub fields: u32,
+        /// Tokenizer modes (`UDPIPE_TOKENIZER_*` mask).
+        pub tokenizer: u32,
     }
 
-    /// A multiword token.
+    /// Per-stage counters of a parser or a model.
+    #[repr(C)]
+    #[derive(Clone, Copy)]
+    pub struct UdpipeStats {
+        /// Nanoseconds spent tokenizing.
+        pub tokenize_ns: u64,
+        /// Nanoseconds spent tagging.
+        pub tag_ns: u64,
+        /// Nanoseconds spent dependency parsing.
+        pub parse_ns: u64,
+        /// Nanoseconds spent building and converting results.
+        pub build_ns: u64,
+        /// Sentences fully processed.
+        pub sentences: u64,
+        /// Words tokenized (excluding the virtual root).
+        pub words: u64,
+        /// Bytes of input text.
+        pub bytes: u64,
+    }
+
+    /// A borrowed string with explicit length (`data[len]` is NUL).
+    #[repr(C)]
+    #[derive(Clone, Copy)]
+    pub struct UdpipeStr {
+        /// Pointer to the first byte (null for an absent value).
+        pub data: *const c_char,
+        /// Length in bytes, excluding the trailing NUL.
+        pub len: usize,
+    }
+
+    /// A single word from a sentence, with string lengths.
+    #[repr(C)]
+    pub struct UdpipeWordView {
+        /// Word form (the actual text).
+        pub form: UdpipeStr,
+        /// Lemma (base form).
+        pub lemma: UdpipeStr,
+        /// Universal POS tag.
+        pub upostag: UdpipeStr,
+        /// Language-specific POS tag.
+        pub xpostag: UdpipeStr,
+        /// Morphological features.
+        pub feats: UdpipeStr,
+        /// Dependency relation.
+        pub deprel: UdpipeStr,
+        /// Enhanced dependencies.
+        pub deps: UdpipeStr,
+        /// Miscellaneous annotations.
+        pub misc: UdpipeStr,
+        /// Array of child word IDs.
+        pub children: *const i32,
+        /// Word ID (1-indexed).
+        pub id: i32,
+        /// Head word ID (0 = root).
+        pub head: i32,
+        /// Number of children.
+        pub children_count: i32,
+        /// Byte offset of the token in the parser's text.
+        pub start: usize,
+        /// Byte offset just past the token.
+        pub end: usize,
+    }
+
+    /// A multiword token, with string lengths.
+    #[repr(C)]
+    pub struct UdpipeMultiwordTokenView {
+        /// Token form (the actual text).
+        pub form: UdpipeStr,
+        /// Miscellaneous annotations.
+        pub misc: UdpipeStr,
+        /// First word ID in the range.
+        pub id_first: i32,
+        /// Last word ID in the range.
+        pub id_last: i32,
+    }
+
+    /// A multiword token (NUL-terminated strings; the crate reads
+    /// [`UdpipeMultiwordTokenView`] instead).
+    #[cfg(test)]
     #[repr(C)]
     pub struct UdpipeMultiwordToken {
         /// Token form (the actual text).
@@ -233,42 +692,116 @@ mod ffi {
             len: usize,
             out_error: *mut *const c_char,
         ) -> *mut UdpipeModel;
+        pub fn udpipe_model_load_mmap(
+            model_path: *const c_char,
+            out_error: *mut *const c_char,
+        ) -> *mut UdpipeModel;
         pub fn udpipe_model_free(model: *mut UdpipeModel);
 
+        // Thread placement
+        pub fn udpipe_thread_set_cpus(cpus: *const usize, len: usize) -> bool;
+        pub fn udpipe_thread_current_cpu() -> i32;
+
+        // Stats
+        pub fn udpipe_model_set_stats_enabled(model: *mut UdpipeModel, enabled: bool);
+        pub fn udpipe_model_stats_enabled(model: *mut UdpipeModel) -> bool;
+        pub fn udpipe_model_get_stats(model: *mut UdpipeModel) -> UdpipeStats;
+        pub fn udpipe_model_reset_stats(model: *mut UdpipeModel);
+        pub fn udpipe_parser_get_stats(parser: *mut UdpipeParser) -> UdpipeStats;
+        pub fn udpipe_parser_add_build_ns(parser: *mut UdpipeParser, ns: u64);
+        pub fn udpipe_raw_sentence_add_build_ns(raw: *mut UdpipeRawSentence, ns: u64);
+
         // Parser functions
+        #[cfg(test)]
         pub fn udpipe_parser_new(
             model: *mut UdpipeModel,
             text: *const c_char,
             text_len: usize,
             out_error: *mut *const c_char,
         ) -> *mut UdpipeParser;
+        pub fn udpipe_parser_new_with_options(
+            model: *mut UdpipeModel,
+            text: *const c_char,
+            text_len: usize,
+            options: *const UdpipeParseOptions,
+            out_error: *mut *const c_char,
+        ) -> *mut UdpipeParser;
         pub fn udpipe_parser_next(
             parser: *mut UdpipeParser,
             out_error: *mut *const c_char,
         ) -> *mut UdpipeSentence;
         pub fn udpipe_parser_has_error(parser: *mut UdpipeParser) -> bool;
+        pub fn udpipe_parser_set_text(
+            parser: *mut UdpipeParser,
+            text: *const c_char,
+            text_len: usize,
+            out_error: *mut *const c_char,
+        ) -> bool;
+        pub fn udpipe_parser_reset(
+            parser: *mut UdpipeParser,
+            text: *const c_char,
+            text_len: usize,
+            out_error: *mut *const c_char,
+        ) -> bool;
         pub fn udpipe_parser_free(parser: *mut UdpipeParser);
 
-        // Sentence - general
-        pub fn udpipe_sentence_free(sentence: *mut UdpipeSentence);
+        // Raw sentences (pipeline stages run separately)
+        pub fn udpipe_parser_next_raw(
+            parser: *mut UdpipeParser,
+            out_error: *mut *const c_char,
+        ) -> *mut UdpipeRawSentence;
+        pub fn udpipe_raw_sentence_new(
+            model: *mut UdpipeModel,
+            forms: *const UdpipeStr,
+            count: usize,
+            options: *const UdpipeParseOptions,
+            out_error: *mut *const c_char,
+        ) -> *mut UdpipeRawSentence;
+        pub fn udpipe_raw_sentence_tag(
+            model: *mut UdpipeModel,
+            raw: *mut UdpipeRawSentence,
+            out_error: *mut *const c_char,
+        ) -> bool;
+        pub fn udpipe_raw_sentence_parse(
+            model: *mut UdpipeModel,
+            raw: *mut UdpipeRawSentence,
+            out_error: *mut *const c_char,
+        ) -> bool;
+        pub fn udpipe_raw_sentence_result(raw: *mut UdpipeRawSentence) -> *mut UdpipeSentence;
+        pub fn udpipe_raw_sentence_free(raw: *mut UdpipeRawSentence);
 
-        // Sentence - words
+        // Sentence - words (sentences are owned by the parser that returned them)
         pub fn udpipe_sentence_word_count(sentence: *mut UdpipeSentence) -> i32;
+        #[cfg(test)]
         pub fn udpipe_sentence_get_word(sentence: *mut UdpipeSentence, index: i32) -> UdpipeWord;
+        pub fn udpipe_sentence_get_word_view(
+            sentence: *mut UdpipeSentence,
+            index: i32,
+        ) -> UdpipeWordView;
 
         // Sentence - multiword tokens
         pub fn udpipe_sentence_multiword_token_count(sentence: *mut UdpipeSentence) -> i32;
+        #[cfg(test)]
         pub fn udpipe_sentence_get_multiword_token(
             sentence: *mut UdpipeSentence,
             index: i32,
         ) -> UdpipeMultiwordToken;
+        pub fn udpipe_sentence_get_multiword_token_view(
+            sentence: *mut UdpipeSentence,
+            index: i32,
+        ) -> UdpipeMultiwordTokenView;
 
         // Sentence - comments
         pub fn udpipe_sentence_comment_count(sentence: *mut UdpipeSentence) -> i32;
+        #[cfg(test)]
         pub fn udpipe_sentence_get_comment(
             sentence: *mut UdpipeSentence,
             index: i32,
         ) -> *const c_char;
+        pub fn udpipe_sentence_get_comment_view(
+            sentence: *mut UdpipeSentence,
+            index: i32,
+        ) -> UdpipeStr;
     }
 }
 
@@ -307,56 +840,36 @@ fn ffi_try<T>(
 ///
 /// # Thread Safety
 ///
-/// `Model` is [`Send`] but **not** [`Sync`]. This means:
-///
-/// - **Safe**: Moving a model to another thread (`std::thread::spawn`)
-/// - **Safe**: Using a model from one thread at a time
-/// - **Unsafe**: Sharing `&Model` across threads (won't compile)
-///
-/// The underlying `UDPipe` C++ library mutates internal workspace caches during
-/// parsing operations. While the library uses thread-safe pools for cache
-/// allocation, concurrent parsing on the same model instance would race on the
-/// workspace contents.
-///
-/// ## Concurrent Access Patterns
+/// `Model` is [`Send`] and [`Sync`]: one loaded model can be shared by
+/// reference (or through an [`Arc`](std::sync::Arc)) and parsed from many
+/// threads at once, without a mutex and without loading a copy per thread.
 ///
-/// If you need to parse from multiple threads, you have two options:
+/// The model itself is read-only after loading. Each [`Parser`] owns its own
+/// tokenizer, and the tagger/parser workspaces that `UDPipe` mutates while
+/// processing a sentence are taken from (and returned to) thread-safe pools
+/// inside the model, so concurrent parsers never share scratch state.
+/// [`Parser`] is [`Send`] but not [`Sync`].
 ///
-/// 1. **Shared model with mutex** (lower memory, serialized parsing):
+/// Across processes, a model loaded before `fork()` is shared copy-on-write
+/// and stays mostly shared: parsing only reads the model tables, but they are
+/// ordinary heap allocations, so allocations and frees in a child still copy
+/// the pages they share with allocator metadata and other heap objects. Fork
+/// before parsing or starting any threads in the parent (see the README).
 ///
 /// ```no_run
-/// use std::sync::{Arc, Mutex};
-///
 /// use udpipe_rs::Model;
 ///
-/// let model = Arc::new(Mutex::new(Model::load("model.udpipe").unwrap()));
-///
-/// // In each thread: hold the lock while parsing
-/// let guard = model.lock().unwrap();
-/// for sentence in guard.parser("text").unwrap() {
-///     // ...
-/// }
-/// // Lock released when guard is dropped
-/// ```
-///
-/// 2. **Separate model per thread** (higher memory, parallel parsing):
-///
-/// ```no_run
-/// use udpipe_rs::Model;
+/// let model = Model::load("model.udpipe").unwrap();
 ///
 /// std::thread::scope(|s| {
-///     s.spawn(|| {
-///         let model = Model::load("model.udpipe").unwrap();
-///         for sentence in model.parser("text from thread 1").unwrap() {
-///             // ...
-///         }
-///     });
-///     s.spawn(|| {
-///         let model = Model::load("model.udpipe").unwrap();
-///         for sentence in model.parser("text from thread 2").unwrap() {
-///             // ...
-///         }
-///     });
+///     for text in ["text from thread 1", "text from thread 2"] {
+///         let model = &model;
+///         s.spawn(move || {
+///             for sentence in model.parser(text).unwrap() {
+///                 // ...
+///             }
+///         });
+///     }
 /// });
 /// ```
 pub struct Model {
@@ -380,9 +893,25 @@ impl std::fmt::Debug for Model {
 // - Internal caches use atomic spin-locks (threadsafe_stack with atomic_flag)
 // - Global statics (ragel_map, lzma allocators) are read-only after init
 // - Our C++ wrapper uses thread_local only for error messages, which are
-//   captured immediately after each FFI call on the calling thread
+//   captured immediately after each FFI call on the calling thread, and for
+//   the index of the stats shard a thread adds to, which any thread may use
 unsafe impl Send for Model {}
 
+// SAFETY: Sharing `&Model` across threads is safe.
+//
+// Verified by auditing vendor/udpipe/src:
+// - `model::new_tokenizer`, `model::tag` and `model::parse` are `const` and
+//   only read the loaded model data
+// - model_morphodita_parsito keeps its mutable tagger/parser workspaces in
+//   `mutable threadsafe_stack` caches: each call pops a private workspace (or
+//   allocates one) and pushes it back when done, so no two threads ever use
+//   the same workspace
+// - Tokenizers returned by `new_tokenizer` are owned by a single Parser
+// - Our C++ wrapper only mutates `UdpipeModel` after loading through atomics:
+//   the `stats_enabled` flag and the stats counters, updated with relaxed
+//   atomic operations from any thread
+unsafe impl Sync for Model {}
+
 impl Model {
     /// Load a model from a file path.
     ///
@@ -418,6 +947,49 @@ impl Model {
         Ok(Self { inner: model })
     }
 
+    /// Load a model from a file through a read-only memory mapping.
+    ///
+    /// This only avoids the small stream buffer that [`Model::load`] reads
+    /// the file through; it does not lower peak memory. `UDPipe` still
+    /// copies each compressed section to the heap before expanding it, as
+    /// with [`Model::load`]. Mapped pages count towards the process's
+    /// resident memory once read, so they are dropped as loading moves past
+    /// them, keeping peak memory at that of [`Model::load`] rather than
+    /// adding the whole file. The mapping is released once loading finishes.
+    /// On platforms without `mmap` this behaves like [`Model::load`].
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if the file cannot be opened or mapped, or is not a
+    /// valid `UDPipe` model.
+    ///
+    /// # Example
+    /// ```no_run
+    /// use udpipe_rs::Model;
+    /// let model = Model::load_mmap("english-ewt-ud-2.5-191206.udpipe").expect("Failed to load model");
+    /// ```
+    pub fn load_mmap(path: impl AsRef<Path>) -> Result<Self, UdpipeError> {
+        let path_str = path.as_ref().to_string_lossy();
+        let c_path = CString::new(path_str.as_bytes()).map_err(|_| {
+            UdpipeError::new(
+                UdpipeErrorKind::NullByteInText,
+                "Invalid path (contains null byte)",
+            )
+        })?;
+
+        let mut out_error: *const std::os::raw::c_char = std::ptr::null();
+        let model = ffi_try(
+            &mut out_error,
+            |e| {
+                // SAFETY: `c_path` is a valid NUL-terminated C string; `e` is a valid out-error
+                // pointer.
+                unsafe { ffi::udpipe_model_load_mmap(c_path.as_ptr(), e) }
+            },
+            UdpipeErrorKind::ModelLoadFailed,
+        )?;
+        Ok(Self { inner: model })
+    }
+
     /// Load a model from a byte slice.
     ///
     /// This is useful for loading models from network sources or embedded data.
@@ -451,10 +1023,13 @@ impl Model {
     /// Returns an iterator that yields sentences one at a time. Each sentence
     /// is tokenized, tagged, lemmatized, and parsed for dependencies.
     ///
+    /// The text is not copied: the parser tokenizes it in place and borrows it
+    /// for its whole lifetime. (In 1.x the parser copied the text and
+    /// borrowed only the model; see the README on upgrading.)
+    ///
     /// # Errors
     ///
-    /// Returns an error if the text contains a null byte or if the parser
-    /// cannot be created.
+    /// Returns an error if the parser cannot be created.
     ///
     /// # Example
     /// ```no_run
@@ -471,41 +1046,93 @@ impl Model {
     ///     }
     /// }
     /// ```
-    pub fn parser(&self, text: &str) -> Result<Parser<'_>, UdpipeError> {
-        let c_text = CString::new(text).map_err(|_| {
-            UdpipeError::new(
-                UdpipeErrorKind::NullByteInText,
-                "Invalid text (contains null byte)",
-            )
-        })?;
+    pub fn parser<'a>(&'a self, text: &'a str) -> Result<Parser<'a>, UdpipeError> {
+        self.parser_with_options(text, ParseOptions::default())
+    }
 
+    /// Create a parser for the given text with explicit [`ParseOptions`].
+    ///
+    /// Use this to skip pipeline stages whose output is not needed, e.g.
+    /// [`Stages::Tag`] when only lemmas and POS tags are read: dependency
+    /// parsing is the most expensive stage.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if the parser cannot be created.
+    ///
+    /// # Example
+    /// ```no_run
+    /// use udpipe_rs::{Model, ParseOptions, Stages};
+    ///
+    /// let model = Model::load("english-ewt-ud-2.5-191206.udpipe").expect("Failed to load");
+    /// let options = ParseOptions::default().stages(Stages::Tag);
+    /// for sentence in model
+    ///     .parser_with_options("The quick brown fox.", options)
+    ///     .expect("Failed to create parser")
+    /// {
+    ///     let sentence = sentence.expect("Failed to parse sentence");
+    ///     for word in &sentence.words {
+    ///         println!("{} -> {} ({})", word.form, word.lemma, word.upostag);
+    ///     }
+    /// }
+    /// ```
+    pub fn parser_with_options<'a>(
+        &'a self,
+        text: &'a str,
+        options: ParseOptions,
+    ) -> Result<Parser<'a>, UdpipeError> {
+        let options = options.to_ffi();
         let mut out_error: *const std::os::raw::c_char = std::ptr::null();
         let parser = ffi_try(
             &mut out_error,
             |e| {
-                // SAFETY: `self.inner` is a valid model; `c_text` is NUL-terminated; `e` is a
-                // valid out-error pointer. Length is the string byte length (no trailing null).
-                unsafe { ffi::udpipe_parser_new(self.inner, c_text.as_ptr(), text.len(), e) }
+                // SAFETY: `self.inner` is a valid model; `text` is valid for `text.len()` bytes
+                // and, through the returned `Parser<'a>`, outlives the C++ parser that keeps
+                // pointing into it; `options` outlives the call; `e` is a valid out-error
+                // pointer.
+                unsafe {
+                    ffi::udpipe_parser_new_with_options(
+                        self.inner,
+                        text.as_ptr().cast(),
+                        text.len(),
+                        &raw const options,
+                        e,
+                    )
+                }
             },
             UdpipeErrorKind::ParserCreationFailed,
         )?;
         Ok(Parser {
             inner: parser,
             errored: false,
+            stats: self.stats_enabled(),
             _model: self,
         })
     }
 }
 
-/// Convert a C string pointer to an owned `String`.
-fn ptr_to_string(ptr: *const std::os::raw::c_char) -> String {
-    if ptr.is_null() {
-        return String::new();
+/// Borrow a length-delimited C++ string as `&str`.
+///
+/// Null maps to `""`; invalid UTF-8 maps to `"\u{FFFD}"`. The caller chooses
+/// the lifetime and must not let it outlive the C++ buffer.
+fn view_to_str<'a>(view: ffi::UdpipeStr) -> &'a str {
+    std::str::from_utf8(view_bytes(view)).unwrap_or("\u{FFFD}")
+}
+
+/// Copy a `(data, len)` string view into an owned `String`, replacing each
+/// invalid UTF-8 sequence with U+FFFD. Valid input is copied as is.
+fn view_to_string(view: ffi::UdpipeStr) -> String {
+    String::from_utf8_lossy(view_bytes(view)).into_owned()
+}
+
+/// The bytes of a `(data, len)` string view; empty for a null view. As with
+/// [`view_to_str`], the caller chooses the lifetime.
+const fn view_bytes<'a>(view: ffi::UdpipeStr) -> &'a [u8] {
+    if view.data.is_null() {
+        return &[];
     }
-    // SAFETY: FFI guarantees the pointer is valid and null-terminated.
-    unsafe { CStr::from_ptr(ptr) }
-        .to_string_lossy()
-        .into_owned()
+    // SAFETY: FFI guarantees `data` is valid for `len` bytes.
+    unsafe { std::slice::from_raw_parts(view.data.cast::<u8>(), view.len) }
 }
 
 impl Drop for Model {
@@ -519,7 +1146,7 @@ impl Drop for Model {
 
 /// A streaming parser that yields sentences one at a time.
 ///
-/// Created by [`Model::parser`]. Implements [`Iterator`] where each item is a
+/// Created by [`Model::parser`]. Borrows both the model and the text it parses. Implements [`Iterator`] where each item is a
 /// [`Result<Sentence, UdpipeError>`].
 ///
 /// Once an error occurs, the iterator is "fused" and will return `None` for
@@ -529,7 +1156,10 @@ pub struct Parser<'a> {
     inner: *mut ffi::UdpipeParser,
     /// Whether an error has occurred (fuses the iterator).
     errored: bool,
+    /// Whether stats were enabled on the model when the parser was created.
+    stats: bool,
     /// Reference to the model so it cannot be dropped while the parser exists.
+    /// The lifetime also covers the text, which the C++ parser reads in place.
     _model: &'a Model,
 }
 
@@ -545,10 +1175,27 @@ impl std::fmt::Debug for Parser<'_> {
 // Like Model, it can be sent to another thread but not shared.
 unsafe impl Send for Parser<'_> {}
 
-impl Iterator for Parser<'_> {
-    type Item = Result<Sentence, UdpipeError>;
-
-    fn next(&mut self) -> Option<Self::Item> {
+impl Parser<'_> {
+    /// Advance to the next sentence without copying it into owned strings.
+    ///
+    /// This is the allocation-free counterpart of [`Iterator::next`]: the
+    /// returned [`SentenceRef`] borrows the parser and must be dropped before
+    /// the next call. Use [`SentenceRef::to_sentence`] to keep a copy.
+    ///
+    /// # Example
+    /// ```no_run
+    /// use udpipe_rs::Model;
+    ///
+    /// let model = Model::load("english-ewt-ud-2.5-191206.udpipe").expect("Failed to load");
+    /// let mut parser = model.parser("The quick brown fox.").expect("Failed to create parser");
+    /// while let Some(sentence) = parser.next_ref() {
+    ///     let sentence = sentence.expect("Failed to parse sentence");
+    ///     for word in sentence.words() {
+    ///         println!("{} -> {}", word.form, word.lemma);
+    ///     }
+    /// }
+    /// ```
+    pub fn next_ref(&mut self) -> Option<Result<SentenceRef<'_>, UdpipeError>> {
         if self.errored || self.inner.is_null() {
             return None;
         }
@@ -559,78 +1206,210 @@ impl Iterator for Parser<'_> {
         let sentence_ptr = unsafe { ffi::udpipe_parser_next(self.inner, &raw mut out_error) };
 
         if sentence_ptr.is_null() {
-            // SAFETY: `self.inner` is a valid parser.
-            if unsafe { ffi::udpipe_parser_has_error(self.inner) } {
-                self.errored = true;
-                return Some(Err(UdpipeError::new(
-                    UdpipeErrorKind::ParseError,
-                    copy_error_message(out_error),
-                )));
-            }
+            return self.end_or_error(out_error);
+        }
+
+        Some(Ok(SentenceRef {
+            inner: sentence_ptr,
+            _parser: std::marker::PhantomData,
+        }))
+    }
+
+    /// Tokenize the next sentence without tagging or parsing it.
+    ///
+    /// The returned [`RawSentence`] is independent of the parser and can be
+    /// finished on another thread.
+    pub(crate) fn next_raw(&mut self) -> Option<Result<RawSentence, UdpipeError>> {
+        if self.errored || self.inner.is_null() {
             return None;
         }
 
-        let ptr = sentence_ptr;
-        Some(Ok({
-            // SAFETY: `ptr` is a valid, non-null pointer from `udpipe_parser_next`.
-            let word_count = unsafe { ffi::udpipe_sentence_word_count(ptr) };
-            let mut words = Vec::with_capacity(usize::try_from(word_count).unwrap_or(0));
-            for i in 0..word_count {
-                // SAFETY: ptr valid; index in range (see above).
-                let w = unsafe { ffi::udpipe_sentence_get_word(ptr, i) };
-                let children = if w.children.is_null() || w.children_count <= 0 {
-                    Vec::new()
-                } else {
-                    let count = usize::try_from(w.children_count).unwrap_or(0);
-                    // SAFETY: w.children is valid for w.children_count elements.
-                    unsafe { std::slice::from_raw_parts(w.children, count) }.to_vec()
-                };
-                words.push(Word {
-                    form: ptr_to_string(w.form),
-                    lemma: ptr_to_string(w.lemma),
-                    upostag: ptr_to_string(w.upostag),
-                    xpostag: ptr_to_string(w.xpostag),
-                    feats: ptr_to_string(w.feats),
-                    deprel: ptr_to_string(w.deprel),
-                    deps: ptr_to_string(w.deps),
-                    misc: ptr_to_string(w.misc),
-                    id: w.id,
-                    head: w.head,
-                    children,
-                });
-            }
-            // SAFETY: ptr valid (see above).
-            let mwt_count = unsafe { ffi::udpipe_sentence_multiword_token_count(ptr) };
-            let mut multiword_tokens = Vec::with_capacity(usize::try_from(mwt_count).unwrap_or(0));
-            for i in 0..mwt_count {
-                // SAFETY: ptr valid; index in range (see above).
-                let mwt = unsafe { ffi::udpipe_sentence_get_multiword_token(ptr, i) };
-                multiword_tokens.push(MultiwordToken {
-                    form: ptr_to_string(mwt.form),
-                    misc: ptr_to_string(mwt.misc),
-                    id_first: mwt.id_first,
-                    id_last: mwt.id_last,
-                });
-            }
-            // SAFETY: ptr valid (see above).
-            let comment_count = unsafe { ffi::udpipe_sentence_comment_count(ptr) };
-            let mut comments = Vec::with_capacity(usize::try_from(comment_count).unwrap_or(0));
-            for i in 0..comment_count {
-                comments.push(ptr_to_string(
-                    // SAFETY: ptr valid; index in range (see above).
-                    unsafe { ffi::udpipe_sentence_get_comment(ptr, i) },
-                ));
-            }
-            // SAFETY: ptr is our exclusive ownership from udpipe_parser_next; we may free
-            // it.
-            unsafe { ffi::udpipe_sentence_free(ptr) };
-            Sentence {
-                words,
-                multiword_tokens,
-                comments,
-            }
+        let mut out_error: *const std::os::raw::c_char = std::ptr::null();
+        // SAFETY: `self.inner` is a valid parser; `out_error` is a valid out-error
+        // pointer.
+        let raw = unsafe { ffi::udpipe_parser_next_raw(self.inner, &raw mut out_error) };
+
+        if raw.is_null() {
+            return self.end_or_error(out_error);
+        }
+
+        Some(Ok(RawSentence {
+            inner: raw,
+            stats: self.stats,
         }))
     }
+
+    /// Continue the document with `text` once every sentence of the current
+    /// text has been returned.
+    ///
+    /// # Safety
+    ///
+    /// The C++ parser reads `text` in place: it must stay alive and unchanged
+    /// until the parser has returned its last sentence (`next` yields `None`),
+    /// the next `reset`, or until the parser is dropped.
+    pub(crate) unsafe fn set_text(&mut self, text: &str) -> Result<(), UdpipeError> {
+        let mut out_error: *const std::os::raw::c_char = std::ptr::null();
+        // SAFETY: `self.inner` is a valid parser (or null, which the C++ side
+        // rejects); the caller keeps `text` alive; `out_error` is a valid
+        // out-error pointer.
+        let ok = unsafe {
+            ffi::udpipe_parser_set_text(
+                self.inner,
+                text.as_ptr().cast(),
+                text.len(),
+                &raw mut out_error,
+            )
+        };
+        stage_result(ok, out_error)
+    }
+
+    /// Start a new document with `text`, reusing the tokenizer and buffers
+    /// and clearing any earlier error.
+    ///
+    /// # Safety
+    ///
+    /// As for [`Parser::set_text`].
+    pub(crate) unsafe fn reset(&mut self, text: &str) -> Result<(), UdpipeError> {
+        let mut out_error: *const std::os::raw::c_char = std::ptr::null();
+        // SAFETY: `self.inner` is a valid parser (or null, which the C++ side
+        // rejects); the caller keeps `text` alive; `out_error` is a valid
+        // out-error pointer.
+        let ok = unsafe {
+            ffi::udpipe_parser_reset(
+                self.inner,
+                text.as_ptr().cast(),
+                text.len(),
+                &raw mut out_error,
+            )
+        };
+        self.errored = !ok;
+        stage_result(ok, out_error)
+    }
+
+    /// Handle a null result from the parser: `None` at end of text, or the
+    /// error (fusing the parser) if `UDPipe` reported one.
+    fn end_or_error<T>(
+        &mut self,
+        out_error: *const std::os::raw::c_char,
+    ) -> Option<Result<T, UdpipeError>> {
+        // SAFETY: `self.inner` is a valid parser.
+        if unsafe { ffi::udpipe_parser_has_error(self.inner) } {
+            self.errored = true;
+            return Some(Err(UdpipeError::new(
+                UdpipeErrorKind::ParseError,
+                copy_error_message(out_error),
+            )));
+        }
+        None
+    }
+}
+
+/// A tokenized sentence detached from its [`Parser`], awaiting tagging and
+/// parsing (possibly on another thread).
+pub(crate) struct RawSentence {
+    /// Raw pointer to the C++ raw sentence (owned).
+    inner: *mut ffi::UdpipeRawSentence,
+    /// Whether to time the conversion into a [`Sentence`].
+    stats: bool,
+}
+
+// SAFETY: A raw sentence owns its C++ data outright (it shares nothing with the
+// parser that produced it), so it may move between threads.
+unsafe impl Send for RawSentence {}
+
+impl RawSentence {
+    /// Run the tagger and the dependency parser of `model` on this sentence and
+    /// copy the result into an owned [`Sentence`].
+    pub(crate) fn process(mut self, model: &Model) -> Result<Sentence, UdpipeError> {
+        self.tag(model)?;
+        self.parse(model)?;
+        Ok(self.into_sentence())
+    }
+
+    /// Run the tagger of `model` on this sentence.
+    pub(crate) fn tag(&mut self, model: &Model) -> Result<(), UdpipeError> {
+        let mut out_error: *const std::os::raw::c_char = std::ptr::null();
+        // SAFETY: `model.inner` and `self.inner` are valid (or null, which the C++
+        // side rejects); `out_error` is a valid out-error pointer.
+        let ok =
+            unsafe { ffi::udpipe_raw_sentence_tag(model.inner, self.inner, &raw mut out_error) };
+        stage_result(ok, out_error)
+    }
+
+    /// Run the dependency parser of `model` on this (tagged) sentence.
+    pub(crate) fn parse(&mut self, model: &Model) -> Result<(), UdpipeError> {
+        let mut out_error: *const std::os::raw::c_char = std::ptr::null();
+        // SAFETY: `model.inner` and `self.inner` are valid (or null, which the C++
+        // side rejects); `out_error` is a valid out-error pointer.
+        let ok =
+            unsafe { ffi::udpipe_raw_sentence_parse(model.inner, self.inner, &raw mut out_error) };
+        stage_result(ok, out_error)
+    }
+
+    /// Copy the processed sentence into an owned [`Sentence`].
+    pub(crate) fn into_sentence(self) -> Sentence {
+        let view = SentenceRef {
+            // SAFETY: `self.inner` is valid; the result lives as long as `self`.
+            inner: unsafe { ffi::udpipe_raw_sentence_result(self.inner) },
+            _parser: std::marker::PhantomData,
+        };
+        if !self.stats {
+            return view.to_sentence();
+        }
+        let start = Instant::now();
+        let sentence = view.to_sentence();
+        // SAFETY: `self.inner` is valid.
+        unsafe { ffi::udpipe_raw_sentence_add_build_ns(self.inner, elapsed_ns(start)) };
+        sentence
+    }
+}
+
+/// Lock `mutex`, ignoring poisoning: the crate's critical sections leave their
+/// state consistent even if a thread panics.
+fn lock<T>(mutex: &std::sync::Mutex<T>) -> std::sync::MutexGuard<'_, T> {
+    mutex
+        .lock()
+        .unwrap_or_else(std::sync::PoisonError::into_inner)
+}
+
+/// Convert the status returned by a [`RawSentence`] stage or a text update into
+/// a `Result`.
+fn stage_result(ok: bool, out_error: *const std::os::raw::c_char) -> Result<(), UdpipeError> {
+    if ok {
+        Ok(())
+    } else {
+        Err(UdpipeError::new(
+            UdpipeErrorKind::ParseError,
+            copy_error_message(out_error),
+        ))
+    }
+}
+
+impl Drop for RawSentence {
+    fn drop(&mut self) {
+        if !self.inner.is_null() {
+            // SAFETY: `self.inner` is valid and we have exclusive ownership.
+            unsafe { ffi::udpipe_raw_sentence_free(self.inner) };
+        }
+    }
+}
+
+impl Iterator for Parser<'_> {
+    type Item = Result<Sentence, UdpipeError>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        if !self.stats {
+            return self
+                .next_ref()
+                .map(|sentence| sentence.map(|s| s.to_sentence()));
+        }
+        let sentence = self.next_ref()?;
+        let start = Instant::now();
+        let sentence = sentence.map(|s| s.to_sentence());
+        // SAFETY: `self.inner` is a valid parser (or null, which is a no-op).
+        unsafe { ffi::udpipe_parser_add_build_ns(self.inner, elapsed_ns(start)) };
+        Some(sentence)
+    }
 }
 
 impl Drop for Parser<'_> {
@@ -944,6 +1723,20 @@ mod tests {
         assert!(err.message.contains("null byte"));
     }
 
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_model_load_mmap_nonexistent_file() {
+        let err = Model::load_mmap("/nonexistent/path/to/model.udpipe").unwrap_err();
+        assert_eq!(err.kind, UdpipeErrorKind::ModelLoadFailed);
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_model_load_mmap_path_with_null_byte() {
+        let err = Model::load_mmap("path\0with\0nulls.udpipe").unwrap_err();
+        assert!(err.message.contains("null byte"));
+    }
+
     #[test]
     #[cfg_attr(miri, ignore)]
     fn test_model_load_from_memory_empty() {
@@ -970,6 +1763,13 @@ mod tests {
         assert!(err.message.contains("Invalid arguments"));
     }
 
+    #[test]
+    fn test_model_is_send_and_sync() {
+        /// Compile-time check that `T` can be shared across threads.
+        const fn assert_send_sync<T: Send + Sync>() {}
+        assert_send_sync::<Model>();
+    }
+
     #[test]
     fn test_model_debug() {
         let model = Model {
@@ -988,6 +1788,7 @@ mod tests {
         let parser = Parser {
             inner: std::ptr::null_mut(),
             errored: false,
+            stats: false,
             _model: &model,
         };
         let debug_str = format!("{parser:?}");
@@ -1053,6 +1854,24 @@ mod tests {
         assert_eq!(count, 0);
     }
 
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_ffi_null_model_parser_new() {
+        let mut out_error: *const std::os::raw::c_char = std::ptr::null();
+        // SAFETY: Testing that a null model is rejected (defensive C++ code); the
+        // text is a valid NUL-terminated string and `out_error` a valid pointer.
+        let parser = unsafe {
+            ffi::udpipe_parser_new(
+                std::ptr::null_mut(),
+                c"test".as_ptr(),
+                4,
+                &raw mut out_error,
+            )
+        };
+        assert!(parser.is_null());
+        assert!(copy_error_message(out_error).contains("Invalid arguments"));
+    }
+
     #[test]
     #[cfg_attr(miri, ignore)]
     fn test_ffi_null_sentence_get_word() {
@@ -1079,6 +1898,7 @@ mod tests {
         let mut parser = Parser {
             inner: std::ptr::null_mut(),
             errored: false,
+            stats: false,
             _model: &model,
         };
         assert!(parser.next().is_none());
@@ -1092,6 +1912,7 @@ mod tests {
         let mut parser = Parser {
             inner: std::ptr::null_mut(),
             errored: true,
+            stats: false,
             _model: &model,
         };
         assert!(parser.next().is_none());
@@ -1133,10 +1954,88 @@ mod tests {
     }
 
     #[test]
-    fn test_ptr_to_string_null() {
-        // Test that ptr_to_string returns empty string for null pointer.
-        // This covers the defensive null check in ptr_to_string.
-        let result = ptr_to_string(std::ptr::null());
+    fn test_view_to_str_null() {
+        // Test that view_to_str returns empty string for null pointer.
+        // This covers the defensive null check in view_to_str.
+        let result = view_to_str(ffi::UdpipeStr {
+            data: std::ptr::null(),
+            len: 0,
+        });
         assert!(result.is_empty());
     }
+
+    #[test]
+    fn test_view_to_str_uses_length() {
+        let bytes = b"form\0misc";
+        let result = view_to_str(ffi::UdpipeStr {
+            data: bytes.as_ptr().cast(),
+            len: 2,
+        });
+        assert_eq!(result, "fo");
+    }
+
+    #[test]
+    fn test_view_to_str_invalid_utf8() {
+        let bytes = b"\xff\xfe";
+        let result = view_to_str(ffi::UdpipeStr {
+            data: bytes.as_ptr().cast(),
+            len: bytes.len(),
+        });
+        assert_eq!(result, "\u{FFFD}");
+    }
+
+    #[test]
+    fn test_view_to_string_keeps_valid_bytes() {
+        let bytes = b"caf\xc3\xa9 \xff!";
+        let result = view_to_string(ffi::UdpipeStr {
+            data: bytes.as_ptr().cast(),
+            len: bytes.len(),
+        });
+        assert_eq!(result, "café \u{FFFD}!");
+        let null = view_to_string(ffi::UdpipeStr {
+            data: std::ptr::null(),
+            len: 0,
+        });
+        assert_eq!(null, "");
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_ffi_null_sentence_get_word_view() {
+        // SAFETY: Testing that null pointer returns zeroed view (defensive C++ code).
+        let word = unsafe { ffi::udpipe_sentence_get_word_view(std::ptr::null_mut(), 0) };
+        assert!(word.form.data.is_null());
+        assert_eq!(word.form.len, 0);
+        assert!(word.children.is_null());
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_ffi_null_sentence_get_comment_view() {
+        // SAFETY: Testing that null pointer returns empty view (defensive C++ code).
+        let comment = unsafe { ffi::udpipe_sentence_get_comment_view(std::ptr::null_mut(), 0) };
+        assert!(comment.data.is_null());
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_sentence_ref_null_is_empty() {
+        let sentence = SentenceRef {
+            inner: std::ptr::null_mut(),
+            _parser: std::marker::PhantomData,
+        };
+        assert_eq!(sentence.word_count(), 0);
+        assert!(sentence.word(0).is_none());
+        assert_eq!(sentence.words().len(), 0);
+        assert_eq!(sentence.multiword_tokens().len(), 0);
+        assert_eq!(sentence.comments().len(), 0);
+        assert_eq!(
+            sentence.to_sentence(),
+            Sentence {
+                words: Vec::new(),
+                multiword_tokens: Vec::new(),
+                comments: Vec::new(),
+            }
+        );
+    }
 }
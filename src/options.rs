@@ -0,0 +1,229 @@
+//! Options controlling what a [`Parser`](crate::Parser) computes and returns.
+
+use std::ops::{BitOr, BitOrAssign};
+
+use crate::ffi;
+
+/// The last `UDPipe` stage a parser runs; each stage includes the ones before
+/// it.
+///
+/// Skipped stages cost nothing. Their [`Word`](crate::Word) fields are left
+/// empty, and [`Word::head`](crate::Word::head) is `-1` when the sentence was
+/// not dependency parsed.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub enum Stages {
+    /// Sentence splitting and tokenization only: `form`, `id`, `misc`,
+    /// multiword tokens and comments.
+    Tokenize,
+    /// Tokenization plus tagging: adds `lemma`, `upostag`, `xpostag` and
+    /// `feats`.
+    Tag,
+    /// The full pipeline: adds `head`, `deprel` and children.
+    #[default]
+    Parse,
+}
+
+impl Stages {
+    /// The `UDPIPE_STAGE_*` constant for this stage.
+    const fn to_ffi(self) -> i32 {
+        match self {
+            Self::Tokenize => ffi::UDPIPE_STAGE_TOKENIZE,
+            Self::Tag => ffi::UDPIPE_STAGE_TAG,
+            Self::Parse => ffi::UDPIPE_STAGE_PARSE,
+        }
+    }
+}
+
+/// A set of result columns to copy out of `UDPipe`.
+///
+/// Columns outside the set are never copied: their strings read as empty,
+/// [`Word::children`](crate::Word::children) as empty, and a
+/// [`Sentence`](crate::Sentence) has no multiword tokens or comments. `id` and
+/// `head` are always filled in. Combine columns with `|`.
+///
+/// ```
+/// use udpipe_rs::Fields;
+///
+/// let fields = Fields::FORM | Fields::LEMMA;
+/// assert!(fields.contains(Fields::LEMMA));
+/// assert!(!fields.contains(Fields::UPOSTAG));
+/// ```
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct Fields(u32);
+
+impl Fields {
+    /// [`Word::form`](crate::Word::form).
+    pub const FORM: Self = Self(ffi::UDPIPE_FIELD_FORM);
+    /// [`Word::lemma`](crate::Word::lemma).
+    pub const LEMMA: Self = Self(ffi::UDPIPE_FIELD_LEMMA);
+    /// [`Word::upostag`](crate::Word::upostag).
+    pub const UPOSTAG: Self = Self(ffi::UDPIPE_FIELD_UPOSTAG);
+    /// [`Word::xpostag`](crate::Word::xpostag).
+    pub const XPOSTAG: Self = Self(ffi::UDPIPE_FIELD_XPOSTAG);
+    /// [`Word::feats`](crate::Word::feats).
+    pub const FEATS: Self = Self(ffi::UDPIPE_FIELD_FEATS);
+    /// [`Word::deprel`](crate::Word::deprel).
+    pub const DEPREL: Self = Self(ffi::UDPIPE_FIELD_DEPREL);
+    /// [`Word::deps`](crate::Word::deps).
+    pub const DEPS: Self = Self(ffi::UDPIPE_FIELD_DEPS);
+    /// [`Word::misc`](crate::Word::misc).
+    pub const MISC: Self = Self(ffi::UDPIPE_FIELD_MISC);
+    /// [`Word::children`](crate::Word::children).
+    pub const CHILDREN: Self = Self(ffi::UDPIPE_FIELD_CHILDREN);
+    /// [`Sentence::multiword_tokens`](crate::Sentence::multiword_tokens).
+    pub const MULTIWORD_TOKENS: Self = Self(ffi::UDPIPE_FIELD_MULTIWORD_TOKENS);
+    /// [`Sentence::comments`](crate::Sentence::comments).
+    pub const COMMENTS: Self = Self(ffi::UDPIPE_FIELD_COMMENTS);
+    /// Every column.
+    pub const ALL: Self = Self(ffi::UDPIPE_FIELD_ALL);
+    /// No columns (only `id` and `head`).
+    pub const NONE: Self = Self(0);
+
+    /// Whether every column of `other` is in this set.
+    #[must_use]
+    pub const fn contains(self, other: Self) -> bool {
+        self.0 & other.0 == other.0
+    }
+
+    /// The columns in either set.
+    #[must_use]
+    pub const fn union(self, other: Self) -> Self {
+        Self(self.0 | other.0)
+    }
+}
+
+impl Default for Fields {
+    fn default() -> Self {
+        Self::ALL
+    }
+}
+
+impl BitOr for Fields {
+    type Output = Self;
+
+    fn bitor(self, rhs: Self) -> Self {
+        self.union(rhs)
+    }
+}
+
+impl BitOrAssign for Fields {
+    fn bitor_assign(&mut self, rhs: Self) {
+        *self = self.union(rhs);
+    }
+}
+
+/// Options for [`Model::parser_with_options`](crate::Model::parser_with_options).
+///
+/// The default runs the full pipeline, like [`Model::parser`](crate::Model::parser).
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ParseOptions {
+    /// Which stages of the pipeline to run.
+    pub stages: Stages,
+    /// Which result columns to copy out of `UDPipe`.
+    pub fields: Fields,
+    /// Treat each line of the input as one sentence and only split it into
+    /// tokens, instead of running `UDPipe`'s sentence segmenter.
+    pub presegmented: bool,
+    /// Fill in [`Word::start`](crate::Word::start) and
+    /// [`Word::end`](crate::Word::end) with the byte range of each word in
+    /// the input text.
+    pub offsets: bool,
+}
+
+impl ParseOptions {
+    /// Set which stages of the pipeline to run.
+    #[must_use]
+    pub const fn stages(mut self, stages: Stages) -> Self {
+        self.stages = stages;
+        self
+    }
+
+    /// Set which result columns to copy out of `UDPipe`.
+    #[must_use]
+    pub const fn fields(mut self, fields: Fields) -> Self {
+        self.fields = fields;
+        self
+    }
+
+    /// Set whether each line of the input is one sentence.
+    #[must_use]
+    pub const fn presegmented(mut self, presegmented: bool) -> Self {
+        self.presegmented = presegmented;
+        self
+    }
+
+    /// Set whether to report the byte range of each word.
+    #[must_use]
+    pub const fn offsets(mut self, offsets: bool) -> Self {
+        self.offsets = offsets;
+        self
+    }
+
+    /// The C representation of these options.
+    pub(super) const fn to_ffi(self) -> ffi::UdpipeParseOptions {
+        ffi::UdpipeParseOptions {
+            stages: self.stages.to_ffi(),
+            fields: self.fields.0,
+            tokenizer: flag(self.presegmented, ffi::UDPIPE_TOKENIZER_PRESEGMENTED)
+                | flag(self.offsets, ffi::UDPIPE_TOKENIZER_RANGES),
+        }
+    }
+}
+
+/// `bit` if `set`, else no bits.
+const fn flag(set: bool, bit: u32) -> u32 {
+    if set { bit } else { 0 }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_parse_options_default_runs_full_pipeline() {
+        assert_eq!(ParseOptions::default().stages, Stages::Parse);
+        assert_eq!(
+            ParseOptions::default().to_ffi().stages,
+            ffi::UDPIPE_STAGE_PARSE
+        );
+    }
+
+    #[test]
+    fn test_stages_are_ordered() {
+        assert!(Stages::Tokenize < Stages::Tag);
+        assert!(Stages::Tag < Stages::Parse);
+        let options = ParseOptions::default().stages(Stages::Tag);
+        assert_eq!(options.to_ffi().stages, ffi::UDPIPE_STAGE_TAG);
+    }
+
+    #[test]
+    fn test_fields_set_operations() {
+        let mut fields = Fields::FORM | Fields::LEMMA;
+        assert!(fields.contains(Fields::FORM));
+        assert!(!fields.contains(Fields::FORM | Fields::MISC));
+        fields |= Fields::MISC;
+        assert!(fields.contains(Fields::FORM | Fields::MISC));
+        assert!(Fields::ALL.contains(fields));
+        assert!(fields.contains(Fields::NONE));
+        assert_eq!(ParseOptions::default().fields, Fields::ALL);
+        assert_eq!(
+            ParseOptions::default().fields(fields).to_ffi().fields,
+            ffi::UDPIPE_FIELD_FORM | ffi::UDPIPE_FIELD_LEMMA | ffi::UDPIPE_FIELD_MISC
+        );
+    }
+
+    #[test]
+    fn test_parse_options_presegmented() {
+        assert_eq!(ParseOptions::default().to_ffi().tokenizer, 0);
+        let options = ParseOptions::default().presegmented(true);
+        assert_eq!(
+            options.to_ffi().tokenizer,
+            ffi::UDPIPE_TOKENIZER_PRESEGMENTED
+        );
+        let options = options.offsets(true);
+        assert_eq!(
+            options.to_ffi().tokenizer,
+            ffi::UDPIPE_TOKENIZER_PRESEGMENTED | ffi::UDPIPE_TOKENIZER_RANGES
+        );
+    }
+}
@@ -0,0 +1,261 @@
+//! Sentence-level parallelism within a single document.
+//!
+//! One thread tokenizes ahead while a pool of workers tags and parses the
+//! tokenized sentences; a reorder buffer restores document order. The
+//! tokenizer takes a credit per sentence and the iterator returns it when it
+//! yields a sentence, so at most `lookahead` sentences are in flight.
+
+use std::collections::BTreeMap;
+use std::sync::mpsc::{self, Receiver, SyncSender};
+use std::sync::{Arc, Mutex};
+use std::thread::Scope;
+
+use crate::{Model, ParseOptions, RawSentence, Sentence, UdpipeError};
+
+/// Options for [`Model::parallel_parser`].
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ParallelOptions {
+    /// Number of tagging/parsing workers. `0` uses
+    /// [`std::thread::available_parallelism`].
+    pub workers: usize,
+    /// Maximum number of sentences tokenized but not yet yielded, which bounds
+    /// how far the tokenizer runs ahead of the consumer and how many parsed
+    /// sentences wait in memory. `0` uses four per worker.
+    pub lookahead: usize,
+    /// Options for the underlying parser.
+    pub parse: ParseOptions,
+}
+
+impl ParallelOptions {
+    /// Set the number of tagging/parsing workers (`0` = one per core).
+    #[must_use]
+    pub const fn workers(mut self, workers: usize) -> Self {
+        self.workers = workers;
+        self
+    }
+
+    /// Set how many sentences may be tokenized ahead of the consumer (`0` =
+    /// four per worker).
+    #[must_use]
+    pub const fn lookahead(mut self, lookahead: usize) -> Self {
+        self.lookahead = lookahead;
+        self
+    }
+
+    /// Set the options for the underlying parser.
+    #[must_use]
+    pub const fn parse_options(mut self, parse: ParseOptions) -> Self {
+        self.parse = parse;
+        self
+    }
+}
+
+/// Iterator over the sentences of one document, tagged and parsed on a pool of
+/// worker threads.
+///
+/// Created by [`Model::parallel_parser`]. Yields sentences in document order
+/// and, like [`Parser`](crate::Parser), is fused after the first error. The
+/// tokenizer stalls while [`ParallelOptions::lookahead`] sentences are waiting
+/// to be yielded. Dropping it stops the tokenizer and workers; they are joined
+/// when the enclosing [`std::thread::scope`] ends.
+#[derive(Debug)]
+pub struct ParallelParser {
+    /// Processed sentences tagged with their position; `None` once fused.
+    results: Option<Receiver<(usize, Result<Sentence, UdpipeError>)>>,
+    /// Returns a credit to the tokenizer per yielded sentence; `None` once
+    /// fused.
+    credits: Option<SyncSender<()>>,
+    /// Sentences that finished ahead of their predecessors.
+    pending: BTreeMap<usize, Result<Sentence, UdpipeError>>,
+    /// Position of the next sentence to yield.
+    next: usize,
+}
+
+impl Iterator for ParallelParser {
+    type Item = Result<Sentence, UdpipeError>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        let results = self.results.as_ref()?;
+        let item = loop {
+            if let Some(item) = self.pending.remove(&self.next) {
+                break item;
+            }
+            let Ok((position, item)) = results.recv() else {
+                self.results = None;
+                self.credits = None;
+                return None;
+            };
+            self.pending.insert(position, item);
+        };
+        self.next += 1;
+        if item.is_err() {
+            // Fuse: dropping the receiver and the credits makes the workers
+            // and tokenizer stop.
+            self.results = None;
+            self.credits = None;
+            self.pending.clear();
+        } else if let Some(credits) = &self.credits {
+            // Never full: the credits in the channel and the sentences in
+            // flight add up to its capacity.
+            let _ = credits.try_send(());
+        }
+        Some(item)
+    }
+}
+
+impl Model {
+    /// Parse one document with sentence-level parallelism.
+    ///
+    /// A tokenizer thread splits `text` into sentences and queues them; worker
+    /// threads take sentences from the queue and tag and parse them
+    /// concurrently against this shared model. The returned iterator yields
+    /// the results in document order. The threads are spawned on `scope`, so
+    /// the model and text only need to outlive the scope.
+    ///
+    /// This pays off for large documents; for many small documents prefer
+    /// [`Model::parse_batch`].
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if the parser cannot be created (see
+    /// [`Model::parser_with_options`]).
+    ///
+    /// # Example
+    /// ```no_run
+    /// use udpipe_rs::{Model, ParallelOptions};
+    ///
+    /// let model = Model::load("english-ewt-ud-2.5-191206.udpipe").expect("Failed to load");
+    /// let text = "A very long document. With many sentences.";
+    /// std::thread::scope(|s| {
+    ///     let parser = model
+    ///         .parallel_parser(s, text, ParallelOptions::default())
+    ///         .expect("Failed to create parser");
+    ///     for sentence in parser {
+    ///         let sentence = sentence.expect("Failed to parse sentence");
+    ///         println!("{} words", sentence.words.len());
+    ///     }
+    /// });
+    /// ```
+    pub fn parallel_parser<'scope, 'env>(
+        &'env self,
+        scope: &'scope Scope<'scope, 'env>,
+        text: &'env str,
+        options: ParallelOptions,
+    ) -> Result<ParallelParser, UdpipeError> {
+        let mut parser = self.parser_with_options(text, options.parse)?;
+
+        let workers = if options.workers == 0 {
+            std::thread::available_parallelism().map_or(1, std::num::NonZeroUsize::get)
+        } else {
+            options.workers
+        };
+        let lookahead = if options.lookahead == 0 {
+            workers.saturating_mul(4)
+        } else {
+            options.lookahead
+        };
+
+        let (credit_tx, credit_rx) = mpsc::sync_channel(lookahead);
+        for _ in 0..lookahead {
+            let _ = credit_tx.try_send(());
+        }
+        let (raw_tx, raw_rx) =
+            mpsc::sync_channel::<(usize, Result<RawSentence, UdpipeError>)>(lookahead);
+        // Unbounded, but never holds more than `lookahead` sentences.
+        let (result_tx, result_rx) = mpsc::channel();
+
+        scope.spawn(move || {
+            // Stops once the iterator is dropped or fused and its credits are
+            // used up.
+            let sentences = std::iter::from_fn(|| {
+                credit_rx.recv().ok()?;
+                parser.next_raw()
+            });
+            for (position, raw) in sentences.enumerate() {
+                if raw_tx.send((position, raw)).is_err() {
+                    break;
+                }
+            }
+        });
+
+        let raw_rx = Arc::new(Mutex::new(raw_rx));
+        for _ in 0..workers {
+            let raw_rx = Arc::clone(&raw_rx);
+            let result_tx = result_tx.clone();
+            scope.spawn(move || {
+                loop {
+                    // Hold the lock only while receiving, not while processing.
+                    let received = raw_rx
+                        .lock()
+                        .map_err(drop)
+                        .and_then(|rx| rx.recv().map_err(drop));
+                    let Ok((position, raw)) = received else {
+                        break;
+                    };
+                    let result = raw.and_then(|raw| raw.process(self));
+                    if result_tx.send((position, result)).is_err() {
+                        break;
+                    }
+                }
+            });
+        }
+
+        Ok(ParallelParser {
+            results: Some(result_rx),
+            credits: Some(credit_tx),
+            pending: BTreeMap::new(),
+            next: 0,
+        })
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_parallel_options_builder() {
+        let options = ParallelOptions::default().workers(3).lookahead(7);
+        assert_eq!(options.workers, 3);
+        assert_eq!(options.lookahead, 7);
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_parallel_parser_with_null_model() {
+        let model = Model {
+            inner: std::ptr::null_mut(),
+        };
+        std::thread::scope(|s| {
+            let err = model
+                .parallel_parser(s, "test", ParallelOptions::default())
+                .unwrap_err();
+            assert!(err.message.contains("Invalid arguments"));
+        });
+    }
+
+    #[test]
+    fn test_parallel_parser_reorders_results() {
+        let (tx, rx) = mpsc::channel();
+        for position in [2, 0, 1] {
+            tx.send((
+                position,
+                Ok(Sentence {
+                    words: Vec::new(),
+                    multiword_tokens: Vec::new(),
+                    comments: vec![position.to_string()],
+                }),
+            ))
+            .unwrap();
+        }
+        drop(tx);
+        let parser = ParallelParser {
+            results: Some(rx),
+            credits: None,
+            pending: BTreeMap::new(),
+            next: 0,
+        };
+        let order: Vec<_> = parser.map(|s| s.unwrap().comments[0].clone()).collect();
+        assert_eq!(order, ["0", "1", "2"]);
+    }
+}
@@ -0,0 +1,242 @@
+//! Pipelined parsing: tokenizer, tagger and dependency parser run as separate
+//! stages on their own threads, connected by bounded queues.
+//!
+//! While sentence k is being parsed, sentence k + 1 can be tagged and sentence
+//! k + 2 tokenized, so consecutive sentences overlap on different cores without
+//! loading the model twice.
+
+use std::sync::mpsc::{self, Receiver, SyncSender};
+use std::thread::Scope;
+
+use crate::{Model, ParseOptions, RawSentence, Sentence, UdpipeError};
+
+/// Default capacity of each queue between pipeline stages.
+const DEFAULT_QUEUE_DEPTH: usize = 4;
+
+/// Options for [`Model::pipelined_parser`].
+///
+/// Each queue depth is the number of sentences that may wait between two stages. A
+/// depth of `0` makes the hand-off synchronous: the upstream stage blocks until
+/// the downstream stage takes the sentence.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct PipelineOptions {
+    /// Tokenized sentences waiting for the tagger.
+    pub tag_queue: usize,
+    /// Tagged sentences waiting for the dependency parser.
+    pub parse_queue: usize,
+    /// Parsed sentences waiting to be yielded by the iterator.
+    pub output_queue: usize,
+    /// Options for the underlying parser. Stages it skips pass straight
+    /// through their pipeline thread.
+    pub parse: ParseOptions,
+}
+
+impl Default for PipelineOptions {
+    fn default() -> Self {
+        Self {
+            tag_queue: DEFAULT_QUEUE_DEPTH,
+            parse_queue: DEFAULT_QUEUE_DEPTH,
+            output_queue: DEFAULT_QUEUE_DEPTH,
+            parse: ParseOptions::default(),
+        }
+    }
+}
+
+impl PipelineOptions {
+    /// Set how many tokenized sentences may wait for the tagger.
+    #[must_use]
+    pub const fn tag_queue(mut self, depth: usize) -> Self {
+        self.tag_queue = depth;
+        self
+    }
+
+    /// Set how many tagged sentences may wait for the dependency parser.
+    #[must_use]
+    pub const fn parse_queue(mut self, depth: usize) -> Self {
+        self.parse_queue = depth;
+        self
+    }
+
+    /// Set how many parsed sentences may wait to be yielded.
+    #[must_use]
+    pub const fn output_queue(mut self, depth: usize) -> Self {
+        self.output_queue = depth;
+        self
+    }
+
+    /// Set the options for the underlying parser.
+    #[must_use]
+    pub const fn parse_options(mut self, parse: ParseOptions) -> Self {
+        self.parse = parse;
+        self
+    }
+}
+
+/// Iterator over the sentences of one document, processed by a three-stage
+/// pipeline.
+///
+/// Created by [`Model::pipelined_parser`]. Yields sentences in document order
+/// and, like [`Parser`](crate::Parser), is fused after the first error.
+/// Dropping it stops all stages; they are joined when the enclosing
+/// [`std::thread::scope`] ends.
+#[derive(Debug)]
+pub struct PipelinedParser {
+    /// Output of the dependency parser stage; `None` once fused.
+    results: Option<Receiver<Result<Sentence, UdpipeError>>>,
+}
+
+impl Iterator for PipelinedParser {
+    type Item = Result<Sentence, UdpipeError>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        let item = self.results.as_ref()?.recv().ok();
+        if !matches!(item, Some(Ok(_))) {
+            // Fuse: dropping the receiver makes every stage stop.
+            self.results = None;
+        }
+        item
+    }
+}
+
+/// Run one pipeline stage: apply `f` to each sentence from `input` and pass it
+/// on, forwarding the first error and then stopping.
+fn run_stage<T, U>(
+    input: &Receiver<Result<T, UdpipeError>>,
+    output: &SyncSender<Result<U, UdpipeError>>,
+    mut f: impl FnMut(T) -> Result<U, UdpipeError>,
+) {
+    for item in input {
+        let item = item.and_then(&mut f);
+        let failed = item.is_err();
+        if output.send(item).is_err() || failed {
+            break;
+        }
+    }
+}
+
+impl Model {
+    /// Parse one document with the tokenizer, tagger and dependency parser
+    /// running as pipelined stages on separate threads.
+    ///
+    /// Each stage hands sentences to the next through a bounded queue whose
+    /// depth is set by `options`, so stages overlap across consecutive
+    /// sentences. Unlike [`Model::parallel_parser`], each stage still handles
+    /// one sentence at a time, which keeps latency per sentence low and uses
+    /// a fixed three threads. The threads are spawned on `scope`, so the
+    /// model and text only need to outlive the scope.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if the parser cannot be created (see
+    /// [`Model::parser_with_options`]).
+    ///
+    /// # Example
+    /// ```no_run
+    /// use udpipe_rs::{Model, PipelineOptions};
+    ///
+    /// let model = Model::load("english-ewt-ud-2.5-191206.udpipe").expect("Failed to load");
+    /// let text = "A long document. With many sentences.";
+    /// std::thread::scope(|s| {
+    ///     let parser = model
+    ///         .pipelined_parser(s, text, PipelineOptions::default().tag_queue(16))
+    ///         .expect("Failed to create parser");
+    ///     for sentence in parser {
+    ///         let sentence = sentence.expect("Failed to parse sentence");
+    ///         println!("{} words", sentence.words.len());
+    ///     }
+    /// });
+    /// ```
+    pub fn pipelined_parser<'scope, 'env>(
+        &'env self,
+        scope: &'scope Scope<'scope, 'env>,
+        text: &'env str,
+        options: PipelineOptions,
+    ) -> Result<PipelinedParser, UdpipeError> {
+        let mut parser = self.parser_with_options(text, options.parse)?;
+
+        let (tokenized_tx, tokenized_rx) = mpsc::sync_channel(options.tag_queue);
+        let (tagged_tx, tagged_rx) = mpsc::sync_channel(options.parse_queue);
+        let (parsed_tx, parsed_rx) = mpsc::sync_channel(options.output_queue);
+
+        scope.spawn(move || {
+            for raw in std::iter::from_fn(|| parser.next_raw()) {
+                if tokenized_tx.send(raw).is_err() {
+                    break;
+                }
+            }
+        });
+        scope.spawn(move || {
+            run_stage(&tokenized_rx, &tagged_tx, |mut raw: RawSentence| {
+                raw.tag(self).map(|()| raw)
+            });
+        });
+        scope.spawn(move || {
+            run_stage(&tagged_rx, &parsed_tx, |mut raw: RawSentence| {
+                raw.parse(self).map(|()| raw.into_sentence())
+            });
+        });
+
+        Ok(PipelinedParser {
+            results: Some(parsed_rx),
+        })
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::UdpipeErrorKind;
+
+    #[test]
+    fn test_pipeline_options_builder() {
+        let options = PipelineOptions::default()
+            .tag_queue(1)
+            .parse_queue(2)
+            .output_queue(0);
+        assert_eq!(options.tag_queue, 1);
+        assert_eq!(options.parse_queue, 2);
+        assert_eq!(options.output_queue, 0);
+        assert_eq!(PipelineOptions::default().tag_queue, DEFAULT_QUEUE_DEPTH);
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_pipelined_parser_with_null_model() {
+        let model = Model {
+            inner: std::ptr::null_mut(),
+        };
+        std::thread::scope(|s| {
+            let err = model
+                .pipelined_parser(s, "test", PipelineOptions::default())
+                .unwrap_err();
+            assert!(err.message.contains("Invalid arguments"));
+        });
+    }
+
+    #[test]
+    fn test_run_stage_stops_after_error() {
+        let (input_tx, input_rx) = mpsc::channel();
+        let (output_tx, output_rx) = mpsc::sync_channel(4);
+        input_tx.send(Ok(1)).unwrap();
+        input_tx.send(Ok(2)).unwrap();
+        input_tx.send(Ok(3)).unwrap();
+        drop(input_tx);
+
+        run_stage(&input_rx, &output_tx, |n: i32| {
+            if n == 2 {
+                Err(UdpipeError::new(
+                    UdpipeErrorKind::ParseError,
+                    "stage failed",
+                ))
+            } else {
+                Ok(n * 10)
+            }
+        });
+        drop(output_tx);
+
+        let results: Vec<_> = output_rx.iter().collect();
+        assert_eq!(results.len(), 2);
+        assert_eq!(results[0].as_ref().ok(), Some(&10));
+        assert!(results[1].is_err());
+    }
+}
@@ -0,0 +1,339 @@
+//! Streaming parsing of text read incrementally from a [`BufRead`], for inputs
+//! too large to hold in memory.
+
+use std::io::{self, BufRead, Read};
+
+use crate::{Model, ParseOptions, Parser, Sentence, UdpipeError, UdpipeErrorKind};
+
+/// Default size at which a block is cut even without a paragraph break.
+const DEFAULT_MAX_BLOCK_BYTES: usize = 1 << 20;
+
+/// Smallest block size: enough for any UTF-8 character, so that every block
+/// makes progress.
+const MIN_BLOCK_BYTES: usize = 4;
+
+/// Options for [`Model::reader_parser_with_options`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ReaderOptions {
+    /// Largest block of input handed to the tokenizer at once. A paragraph
+    /// longer than this is cut at its last line break within the limit, or at
+    /// its last whitespace if there is none. Values below 4 (the longest UTF-8
+    /// character) are treated as 4.
+    pub max_block_bytes: usize,
+    /// Options for the underlying parser.
+    pub parse: ParseOptions,
+}
+
+impl Default for ReaderOptions {
+    fn default() -> Self {
+        Self {
+            max_block_bytes: DEFAULT_MAX_BLOCK_BYTES,
+            parse: ParseOptions::default(),
+        }
+    }
+}
+
+impl ReaderOptions {
+    /// Set the size at which a block is cut without a paragraph break.
+    #[must_use]
+    pub const fn max_block_bytes(mut self, bytes: usize) -> Self {
+        self.max_block_bytes = bytes;
+        self
+    }
+
+    /// Set the options for the underlying parser.
+    #[must_use]
+    pub const fn parse_options(mut self, parse: ParseOptions) -> Self {
+        self.parse = parse;
+        self
+    }
+}
+
+/// Iterator over the sentences of a document read incrementally.
+///
+/// Created by [`Model::reader_parser`]. Only one block of input is held at a
+/// time. Like [`Parser`], it is fused after the first error.
+pub struct ReaderParser<'m, R> {
+    /// Parser over the current block. Declared before `block` so it is dropped
+    /// first: the C++ parser reads `block` in place.
+    parser: Parser<'m>,
+    /// The block of text the parser is reading.
+    block: String,
+    /// Byte offset of `block` in the input.
+    block_start: usize,
+    /// Whether word offsets are reported, and so must be shifted by
+    /// `block_start`.
+    offsets: bool,
+    /// Source of the blocks.
+    input: Blocks<R>,
+    /// Whether the input is exhausted or an error occurred.
+    done: bool,
+}
+
+impl<R> std::fmt::Debug for ReaderParser<'_, R> {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("ReaderParser")
+            .field("parser", &self.parser)
+            .field("block_len", &self.block.len())
+            .field("done", &self.done)
+            .finish_non_exhaustive()
+    }
+}
+
+/// A [`UdpipeErrorKind::ReadFailed`] error caused by `err`.
+fn read_error(err: io::Error) -> UdpipeError {
+    UdpipeError {
+        kind: UdpipeErrorKind::ReadFailed,
+        message: err.to_string(),
+        source: Some(std::sync::Arc::new(err)),
+    }
+}
+
+/// Splits a reader into blocks of text for the tokenizer.
+///
+/// A block runs to the end of the first blank line (a paragraph break, which
+/// no sentence crosses). A block that would exceed `max_bytes` is cut after its
+/// last line break, else after its last whitespace so that no word is split,
+/// else at a UTF-8 character boundary.
+struct Blocks<R> {
+    /// The input.
+    reader: R,
+    /// Bytes read past the end of the previous block when it was cut; they
+    /// start the next block.
+    carry: Vec<u8>,
+    /// See [`ReaderOptions::max_block_bytes`] (at least [`MIN_BLOCK_BYTES`]).
+    max_bytes: usize,
+}
+
+impl<R: BufRead> Blocks<R> {
+    /// Replace the contents of `bytes` with the next block; leaves it empty at
+    /// the end of input.
+    fn read_into(&mut self, bytes: &mut Vec<u8>) -> io::Result<()> {
+        bytes.clear();
+        bytes.append(&mut self.carry);
+        let initial = bytes.len();
+        while bytes.len() < self.max_bytes {
+            let start = bytes.len();
+            let limit = (self.max_bytes - start) as u64;
+            self.reader.by_ref().take(limit).read_until(b'\n', bytes)?;
+            let line = &bytes[start..];
+            if !line.ends_with(b"\n") {
+                if bytes.len() < self.max_bytes {
+                    // End of input.
+                    return Ok(());
+                }
+                break;
+            }
+            if start > initial && line.iter().all(u8::is_ascii_whitespace) {
+                return Ok(());
+            }
+        }
+        if bytes.ends_with(b"\n") {
+            return Ok(());
+        }
+        let cut = bytes
+            .iter()
+            .rposition(|&b| b == b'\n')
+            .or_else(|| bytes.iter().rposition(u8::is_ascii_whitespace))
+            .map_or_else(
+                || match std::str::from_utf8(bytes) {
+                    Err(err) if err.error_len().is_none() => err.valid_up_to(),
+                    _ => bytes.len(),
+                },
+                |pos| pos + 1,
+            );
+        self.carry = bytes.split_off(cut);
+        Ok(())
+    }
+}
+
+impl<R: BufRead> ReaderParser<'_, R> {
+    /// Read the next block and hand it to the parser. Returns `Ok(false)` at
+    /// the end of input.
+    fn refill(&mut self) -> Result<bool, UdpipeError> {
+        self.block_start += self.block.len();
+        let mut bytes = std::mem::take(&mut self.block).into_bytes();
+        self.input.read_into(&mut bytes).map_err(read_error)?;
+        if bytes.is_empty() {
+            return Ok(false);
+        }
+        self.block = String::from_utf8(bytes)
+            .map_err(|err| read_error(io::Error::new(io::ErrorKind::InvalidData, err)))?;
+        // SAFETY: `self.block` is only modified here, after the parser has
+        // reported the end of the previous block (from which point the C++
+        // side no longer reads it), and is dropped after the parser.
+        unsafe { self.parser.set_text(&self.block) }?;
+        Ok(true)
+    }
+}
+
+impl<R: BufRead> Iterator for ReaderParser<'_, R> {
+    type Item = Result<Sentence, UdpipeError>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        while !self.done {
+            match self.parser.next() {
+                Some(Ok(mut sentence)) => {
+                    if self.offsets {
+                        for word in &mut sentence.words {
+                            word.start += self.block_start;
+                            word.end += self.block_start;
+                        }
+                    }
+                    return Some(Ok(sentence));
+                }
+                Some(Err(err)) => {
+                    self.done = true;
+                    return Some(Err(err));
+                }
+                None => match self.refill() {
+                    Ok(true) => {}
+                    Ok(false) => self.done = true,
+                    Err(err) => {
+                        self.done = true;
+                        return Some(Err(err));
+                    }
+                },
+            }
+        }
+        None
+    }
+}
+
+impl Model {
+    /// Parse a document read incrementally from `reader`.
+    ///
+    /// Equivalent to [`Model::reader_parser_with_options`] with default
+    /// options.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if the parser cannot be created.
+    ///
+    /// # Example
+    /// ```no_run
+    /// use std::fs::File;
+    /// use std::io::BufReader;
+    /// use udpipe_rs::Model;
+    ///
+    /// let model = Model::load("english-ewt-ud-2.5-191206.udpipe").expect("Failed to load");
+    /// let file = File::open("crawl.txt").expect("Failed to open");
+    /// for sentence in model.reader_parser(BufReader::new(file)).expect("Failed to create parser") {
+    ///     let sentence = sentence.expect("Failed to parse sentence");
+    ///     println!("{} words", sentence.words.len());
+    /// }
+    /// ```
+    pub fn reader_parser<R: BufRead>(&self, reader: R) -> Result<ReaderParser<'_, R>, UdpipeError> {
+        self.reader_parser_with_options(reader, ReaderOptions::default())
+    }
+
+    /// Parse a document read incrementally from `reader`, with explicit
+    /// [`ReaderOptions`].
+    ///
+    /// The input is read in blocks that end at paragraph breaks (blank
+    /// lines), so memory use is bounded by the largest paragraph rather than
+    /// the document. A paragraph longer than
+    /// [`ReaderOptions::max_block_bytes`] is cut into several blocks (see
+    /// there); a sentence running across such a cut is split in two. The
+    /// result is otherwise the same as [`Model::parser_with_options`] on the
+    /// whole text; in particular, word offsets (see [`ParseOptions::offsets`])
+    /// are relative to the start of the input.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if the parser cannot be created. Reading errors and
+    /// invalid UTF-8 are yielded by the iterator as
+    /// [`UdpipeErrorKind::ReadFailed`].
+    pub fn reader_parser_with_options<R: BufRead>(
+        &self,
+        reader: R,
+        options: ReaderOptions,
+    ) -> Result<ReaderParser<'_, R>, UdpipeError> {
+        Ok(ReaderParser {
+            parser: self.parser_with_options("", options.parse)?,
+            block: String::new(),
+            block_start: 0,
+            offsets: options.parse.offsets,
+            input: Blocks {
+                reader,
+                carry: Vec::new(),
+                max_bytes: options.max_block_bytes.max(MIN_BLOCK_BYTES),
+            },
+            done: false,
+        })
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Split `input` into blocks as [`ReaderParser`] does.
+    fn split_blocks(input: &[u8], max_bytes: usize) -> Vec<Vec<u8>> {
+        let mut blocks = Blocks {
+            reader: input,
+            carry: Vec::new(),
+            max_bytes,
+        };
+        let mut result = Vec::new();
+        loop {
+            let mut bytes = Vec::new();
+            blocks.read_into(&mut bytes).unwrap();
+            if bytes.is_empty() {
+                return result;
+            }
+            result.push(bytes);
+        }
+    }
+
+    #[test]
+    fn test_blocks_end_at_paragraph_breaks() {
+        let blocks = split_blocks(b"One. Two.\nThree.\n\nFour.\n \nFive.", 1024);
+        assert_eq!(
+            blocks,
+            [&b"One. Two.\nThree.\n\n"[..], b"Four.\n \n", b"Five."]
+        );
+    }
+
+    #[test]
+    fn test_blocks_are_capped_at_line_breaks() {
+        let blocks = split_blocks(b"aa\nbb\ncc dd\n", 8);
+        assert_eq!(blocks, [&b"aa\nbb\n"[..], b"cc dd\n"]);
+    }
+
+    #[test]
+    fn test_long_lines_are_cut_between_words() {
+        let blocks = split_blocks(b"ab cd efghij", 5);
+        assert_eq!(blocks, [&b"ab "[..], b"cd ", b"efghi", b"j"]);
+    }
+
+    #[test]
+    fn test_long_lines_keep_utf8_sequences_whole() {
+        let input = "aé€b😀c".as_bytes();
+        let blocks = split_blocks(input, 4);
+        for block in &blocks {
+            assert!(std::str::from_utf8(block).is_ok());
+        }
+        assert_eq!(blocks.concat(), input);
+    }
+
+    #[test]
+    fn test_reader_options_builder() {
+        let options = ReaderOptions::default().max_block_bytes(64);
+        assert_eq!(options.max_block_bytes, 64);
+        assert_eq!(
+            ReaderOptions::default().max_block_bytes,
+            DEFAULT_MAX_BLOCK_BYTES
+        );
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_reader_parser_with_null_model() {
+        let model = Model {
+            inner: std::ptr::null_mut(),
+        };
+        let err = model.reader_parser(&b"test"[..]).unwrap_err();
+        assert!(err.message.contains("Invalid arguments"));
+    }
+}
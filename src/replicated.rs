@@ -0,0 +1,322 @@
+//! NUMA-aware model replication: one copy of a model per NUMA node, so that
+//! each worker reads the weights from memory attached to its own socket.
+
+use std::path::Path;
+
+use crate::{Model, UdpipeError, UdpipeErrorKind, ffi};
+
+/// Directory where Linux describes the NUMA nodes.
+const NODE_DIR: &str = "/sys/devices/system/node";
+
+/// CPU numbers at or above this are rejected as invalid.
+const MAX_CPUS: usize = 1 << 16;
+
+/// A model loaded once per NUMA node, with each worker routed to the replica
+/// on its own node.
+///
+/// On multi-socket machines a thread reading memory attached to another
+/// socket gets a fraction of the local bandwidth, and tagging and parsing
+/// stream through the model weights for every sentence. Each replica is
+/// loaded by a thread pinned to its node's CPUs, so that the kernel's
+/// first-touch policy places the replica's memory on that node.
+/// [`ReplicatedModel::local`] then picks the replica of the node the calling
+/// thread runs on. Every replica costs the memory of a whole model.
+///
+/// On a single-node machine, and where the topology is unknown (outside
+/// Linux), a single copy is loaded and every call returns it.
+///
+/// # Example
+/// ```no_run
+/// use udpipe_rs::ReplicatedModel;
+///
+/// let model = ReplicatedModel::load("english-ewt-ud-2.5-191206.udpipe").expect("Failed to load");
+/// let replicas = model.replicas().len();
+/// std::thread::scope(|s| {
+///     for worker in 0..16 {
+///         let model = &model;
+///         s.spawn(move || {
+///             let local = model
+///                 .bind_current_thread(worker % replicas)
+///                 .expect("Failed to pin worker");
+///             for sentence in local.parser("The quick brown fox.").expect("Failed to create parser") {
+///                 sentence.expect("Failed to parse sentence");
+///             }
+///         });
+///     }
+/// });
+/// ```
+#[derive(Debug)]
+pub struct ReplicatedModel {
+    /// One model per CPU set, in the order the sets were given.
+    replicas: Vec<Model>,
+    /// The CPUs of each replica's node; empty for a single copy.
+    cpus: Vec<Vec<usize>>,
+    /// Replica index of each CPU, indexed by CPU number.
+    cpu_replica: Vec<usize>,
+}
+
+impl ReplicatedModel {
+    /// Load the model at `path` once per NUMA node of this machine (see
+    /// [`ReplicatedModel::numa_nodes`]), or once in total on a single node.
+    ///
+    /// Replicas are loaded concurrently, each as by [`Model::load_mmap`].
+    ///
+    /// # Errors
+    ///
+    /// Returns the error of the first replica that fails to load.
+    pub fn load(path: impl AsRef<Path>) -> Result<Self, UdpipeError> {
+        Self::load_for_cpus(path, &Self::numa_nodes())
+    }
+
+    /// Load the model at `path` once per set of CPUs in `cpu_sets`, each
+    /// replica from a thread restricted to that set.
+    ///
+    /// This is [`ReplicatedModel::load`] for a topology chosen by the caller,
+    /// e.g. only the nodes a container may run on. With fewer than two sets a
+    /// single copy is loaded on the calling thread. Where threads cannot be
+    /// pinned, the replicas are still loaded but may share a node. A CPU
+    /// listed in several sets belongs to the first.
+    ///
+    /// # Errors
+    ///
+    /// Returns an `InvalidInput` error if a CPU number is 65536 or more, and
+    /// otherwise the error of the first replica that fails to load.
+    pub fn load_for_cpus(
+        path: impl AsRef<Path>,
+        cpu_sets: &[Vec<usize>],
+    ) -> Result<Self, UdpipeError> {
+        let path = path.as_ref();
+        if cpu_sets.len() < 2 {
+            return Ok(Self {
+                replicas: vec![Model::load_mmap(path)?],
+                cpus: Vec::new(),
+                cpu_replica: Vec::new(),
+            });
+        }
+        if cpu_sets.iter().flatten().any(|&cpu| cpu >= MAX_CPUS) {
+            return Err(UdpipeError::new(
+                UdpipeErrorKind::InvalidInput,
+                format!("CPU numbers must be below {MAX_CPUS}"),
+            ));
+        }
+
+        let replicas = std::thread::scope(|s| {
+            let mut handles = Vec::with_capacity(cpu_sets.len());
+            for cpus in cpu_sets {
+                handles.push(s.spawn(move || {
+                    // Best effort: an unpinned load still yields a working
+                    // replica, just not necessarily a local one.
+                    pin_current_thread(cpus);
+                    Model::load_mmap(path)
+                }));
+            }
+            handles
+                .into_iter()
+                .map(|handle| {
+                    handle
+                        .join()
+                        .unwrap_or_else(|panic| std::panic::resume_unwind(panic))
+                })
+                .collect::<Result<Vec<_>, _>>()
+        })?;
+
+        let mut cpu_replica = Vec::new();
+        for (replica, cpus) in cpu_sets.iter().enumerate().rev() {
+            for &cpu in cpus {
+                if cpu >= cpu_replica.len() {
+                    cpu_replica.resize(cpu + 1, 0);
+                }
+                cpu_replica[cpu] = replica;
+            }
+        }
+        Ok(Self {
+            replicas,
+            cpus: cpu_sets.to_vec(),
+            cpu_replica,
+        })
+    }
+
+    /// The CPUs of each NUMA node of this machine, for nodes that have any
+    /// (memory-only nodes are left out).
+    ///
+    /// Read from `/sys/devices/system/node`; empty where that is unavailable,
+    /// which includes every platform but Linux.
+    #[must_use]
+    pub fn numa_nodes() -> Vec<Vec<usize>> {
+        let read = |file: &str| std::fs::read_to_string(format!("{NODE_DIR}/{file}")).ok();
+        let Some(nodes) = read("online").and_then(|list| parse_cpu_list(&list)) else {
+            return Vec::new();
+        };
+        nodes
+            .into_iter()
+            .filter_map(|node| parse_cpu_list(&read(&format!("node{node}/cpulist"))?))
+            .filter(|cpus| !cpus.is_empty())
+            .collect()
+    }
+
+    /// The replicas, one per node.
+    #[must_use]
+    pub fn replicas(&self) -> &[Model] {
+        &self.replicas
+    }
+
+    /// The replica on the node the calling thread is running on, or the first
+    /// replica when that is unknown.
+    ///
+    /// The operating system may later move an unpinned thread to another
+    /// node, so call this when a worker picks up a job rather than once per
+    /// process, or pin workers with [`ReplicatedModel::bind_current_thread`].
+    #[must_use]
+    pub fn local(&self) -> &Model {
+        // SAFETY: The call takes no arguments and only queries the calling
+        // thread.
+        let cpu = unsafe { ffi::udpipe_thread_current_cpu() };
+        let replica = usize::try_from(cpu)
+            .ok()
+            .and_then(|cpu| self.cpu_replica.get(cpu))
+            .copied()
+            .unwrap_or(0);
+        &self.replicas[replica]
+    }
+
+    /// Restrict the calling thread to the CPUs of `replica`'s node and return
+    /// that replica.
+    ///
+    /// With a single copy no pinning is done and the copy is returned.
+    ///
+    /// # Errors
+    ///
+    /// Returns an `InvalidInput` error if `replica` is out of range or the
+    /// thread cannot be pinned to the node's CPUs.
+    pub fn bind_current_thread(&self, replica: usize) -> Result<&Model, UdpipeError> {
+        let Some(model) = self.replicas.get(replica) else {
+            return Err(UdpipeError::new(
+                UdpipeErrorKind::InvalidInput,
+                format!(
+                    "Replica {replica} out of range ({} replicas)",
+                    self.replicas.len()
+                ),
+            ));
+        };
+        match self.cpus.get(replica) {
+            Some(cpus) if !pin_current_thread(cpus) => Err(UdpipeError::new(
+                UdpipeErrorKind::InvalidInput,
+                format!("Failed to pin thread to the CPUs of replica {replica}"),
+            )),
+            _ => Ok(model),
+        }
+    }
+}
+
+/// Restrict the calling thread to `cpus`; false if that failed.
+fn pin_current_thread(cpus: &[usize]) -> bool {
+    // SAFETY: `cpus` is a valid slice for the duration of the call.
+    unsafe { ffi::udpipe_thread_set_cpus(cpus.as_ptr(), cpus.len()) }
+}
+
+/// Parse a Linux CPU or node list such as `0-3,8,10-11`.
+fn parse_cpu_list(list: &str) -> Option<Vec<usize>> {
+    let mut cpus = Vec::new();
+    for range in list.trim().split(',').filter(|range| !range.is_empty()) {
+        let (start, end) = range.split_once('-').unwrap_or((range, range));
+        let start: usize = start.parse().ok()?;
+        let end: usize = end.parse().ok()?;
+        if start > end || end >= MAX_CPUS {
+            return None;
+        }
+        cpus.extend(start..=end);
+    }
+    Some(cpus)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Two replicas of a null model, on CPUs 0-1 and 2-3.
+    fn two_replicas() -> ReplicatedModel {
+        ReplicatedModel {
+            replicas: vec![
+                Model {
+                    inner: std::ptr::null_mut(),
+                },
+                Model {
+                    inner: std::ptr::null_mut(),
+                },
+            ],
+            cpus: vec![vec![0, 1], vec![2, 3]],
+            cpu_replica: vec![0, 0, 1, 1],
+        }
+    }
+
+    #[test]
+    fn test_parse_cpu_list() {
+        assert_eq!(
+            parse_cpu_list("0-3,8,10-11\n"),
+            Some(vec![0, 1, 2, 3, 8, 10, 11])
+        );
+        assert_eq!(parse_cpu_list("0\n"), Some(vec![0]));
+        assert_eq!(parse_cpu_list("\n"), Some(vec![]));
+        assert_eq!(parse_cpu_list("3-1"), None);
+        assert_eq!(parse_cpu_list("0-x"), None);
+        assert_eq!(parse_cpu_list("0-65536"), None);
+    }
+
+    #[test]
+    fn test_numa_nodes_have_cpus() {
+        assert!(
+            ReplicatedModel::numa_nodes()
+                .iter()
+                .all(|cpus| !cpus.is_empty())
+        );
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_load_missing_model() {
+        let err = ReplicatedModel::load_for_cpus("/nonexistent.udpipe", &[]).unwrap_err();
+        assert_eq!(err.kind, UdpipeErrorKind::ModelLoadFailed);
+        let err =
+            ReplicatedModel::load_for_cpus("/nonexistent.udpipe", &[vec![0], vec![0]]).unwrap_err();
+        assert_eq!(err.kind, UdpipeErrorKind::ModelLoadFailed);
+    }
+
+    #[test]
+    fn test_load_rejects_huge_cpu() {
+        let err = ReplicatedModel::load_for_cpus("/nonexistent.udpipe", &[vec![0], vec![MAX_CPUS]])
+            .unwrap_err();
+        assert_eq!(err.kind, UdpipeErrorKind::InvalidInput);
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_local_is_a_replica() {
+        let model = two_replicas();
+        let local = model.local();
+        assert!(
+            model
+                .replicas()
+                .iter()
+                .any(|replica| std::ptr::eq(replica, local))
+        );
+    }
+
+    #[test]
+    fn test_bind_out_of_range() {
+        let err = two_replicas().bind_current_thread(2).unwrap_err();
+        assert_eq!(err.kind, UdpipeErrorKind::InvalidInput);
+    }
+
+    #[test]
+    fn test_bind_single_copy_does_not_pin() {
+        let model = ReplicatedModel {
+            replicas: vec![Model {
+                inner: std::ptr::null_mut(),
+            }],
+            cpus: Vec::new(),
+            cpu_replica: Vec::new(),
+        };
+        let bound = model.bind_current_thread(0).unwrap();
+        assert!(std::ptr::eq(bound, model.replicas().as_ptr()));
+    }
+}
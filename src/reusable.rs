@@ -0,0 +1,154 @@
+//! A parser that is created once and reused across many short documents.
+
+use crate::{
+    Model, ParseOptions, ParseStats, Parser, RawSentence, Sentence, SentenceRef, UdpipeError,
+};
+
+/// A parser that keeps its tokenizer and buffers across documents.
+///
+/// Creating a [`Parser`] allocates a new `UDPipe` tokenizer each time. When
+/// handling many tiny documents (queries, tweets), that setup can cost more
+/// than parsing itself. A `ReusableParser` pays it once: each call to
+/// [`ReusableParser::parse`] starts a new document on the same tokenizer and
+/// reuses the sentence buffers and string arena.
+///
+/// Created by [`Model::reusable_parser`].
+///
+/// # Example
+/// ```no_run
+/// use udpipe_rs::Model;
+///
+/// let model = Model::load("english-ewt-ud-2.5-191206.udpipe").expect("Failed to load");
+/// let mut parser = model.reusable_parser().expect("Failed to create parser");
+/// for query in ["first query", "second query"] {
+///     let text = query.to_uppercase();
+///     for sentence in parser.parse(&text).expect("Failed to reset parser") {
+///         let sentence = sentence.expect("Failed to parse sentence");
+///         println!("{} words", sentence.words.len());
+///     }
+/// }
+/// ```
+#[derive(Debug)]
+pub struct ReusableParser<'m> {
+    /// The underlying parser. Its text is only read through a [`Document`],
+    /// which borrows the text it was reset to.
+    parser: Parser<'m>,
+}
+
+impl<'m> ReusableParser<'m> {
+    /// Start parsing `text` as a new document.
+    ///
+    /// The returned [`Document`] iterates over the sentences of `text`; any
+    /// sentences of the previous document not yet read are discarded. An
+    /// error in an earlier document does not carry over.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if the parser could not be reset.
+    pub fn parse<'t>(&'t mut self, text: &'t str) -> Result<Document<'t, 'm>, UdpipeError> {
+        // SAFETY: `text` outlives the returned document, the only way to read
+        // from the parser; the next `parse` replaces the text before any read.
+        unsafe { self.parser.reset(text) }?;
+        Ok(Document {
+            parser: &mut self.parser,
+        })
+    }
+
+    /// Stats of this parser over all documents so far (see
+    /// [`Parser::stats`]).
+    #[must_use]
+    pub fn stats(&self) -> ParseStats {
+        self.parser.stats()
+    }
+}
+
+/// The sentences of one document given to [`ReusableParser::parse`].
+///
+/// Like [`Parser`], it yields owned sentences as an [`Iterator`] or borrowed
+/// ones with [`Document::next_ref`], and is fused after the first error.
+#[derive(Debug)]
+pub struct Document<'t, 'm> {
+    /// The reused parser, reset to this document's text.
+    parser: &'t mut Parser<'m>,
+}
+
+impl Document<'_, '_> {
+    /// Advance to the next sentence without copying it (see
+    /// [`Parser::next_ref`]).
+    pub fn next_ref(&mut self) -> Option<Result<SentenceRef<'_>, UdpipeError>> {
+        self.parser.next_ref()
+    }
+
+    /// Tokenize the next sentence without tagging or parsing it (see
+    /// [`Parser::next_raw`]).
+    pub(super) fn next_raw(&mut self) -> Option<Result<RawSentence, UdpipeError>> {
+        self.parser.next_raw()
+    }
+}
+
+impl Iterator for Document<'_, '_> {
+    type Item = Result<Sentence, UdpipeError>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        self.parser.next()
+    }
+}
+
+impl Model {
+    /// Create a [`ReusableParser`] with default options.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if the parser cannot be created.
+    pub fn reusable_parser(&self) -> Result<ReusableParser<'_>, UdpipeError> {
+        self.reusable_parser_with_options(ParseOptions::default())
+    }
+
+    /// Create a [`ReusableParser`] with explicit [`ParseOptions`], which apply
+    /// to every document.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if the parser cannot be created.
+    pub fn reusable_parser_with_options(
+        &self,
+        options: ParseOptions,
+    ) -> Result<ReusableParser<'_>, UdpipeError> {
+        Ok(ReusableParser {
+            parser: self.parser_with_options("", options)?,
+        })
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_reusable_parser_with_null_model() {
+        let model = Model {
+            inner: std::ptr::null_mut(),
+        };
+        let err = model.reusable_parser().unwrap_err();
+        assert!(err.message.contains("Invalid arguments"));
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_reset_null_parser() {
+        let model = Model {
+            inner: std::ptr::null_mut(),
+        };
+        let mut parser = Parser {
+            inner: std::ptr::null_mut(),
+            errored: false,
+            stats: false,
+            _model: &model,
+        };
+        // SAFETY: The text is static.
+        let err = unsafe { parser.reset("text") }.unwrap_err();
+        assert!(err.message.contains("Invalid arguments"));
+        assert!(parser.next().is_none());
+    }
+}
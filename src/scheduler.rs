@@ -0,0 +1,441 @@
+//! Dynamic micro-batching: small requests from many concurrent callers are
+//! gathered for a short window, then tokenized, tagged and parsed together.
+
+use std::collections::VecDeque;
+use std::sync::mpsc::{self, SyncSender};
+use std::sync::{Arc, Condvar, Mutex, PoisonError};
+use std::thread::JoinHandle;
+use std::time::{Duration, Instant};
+
+use crate::{
+    Model, ParseOptions, RawSentence, ReusableParser, Sentence, UdpipeError, UdpipeErrorKind, lock,
+};
+
+/// Default for [`MicroBatchOptions::max_wait`].
+const DEFAULT_MAX_WAIT: Duration = Duration::from_micros(200);
+
+/// Default for [`MicroBatchOptions::max_batch`].
+const DEFAULT_MAX_BATCH: usize = 32;
+
+/// Options for [`MicroBatcher::new`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct MicroBatchOptions {
+    /// Number of batching threads. `0` uses
+    /// [`std::thread::available_parallelism`]. Each thread forms its own
+    /// batches, so fewer threads make larger batches.
+    pub workers: usize,
+    /// Longest a request waits for others to join its batch. A batch starts
+    /// once its oldest request has waited this long, or as soon as it is full.
+    pub max_wait: Duration,
+    /// Most requests in one batch. Values below 1 are treated as 1.
+    pub max_batch: usize,
+    /// Options for the parser of each request.
+    pub parse: ParseOptions,
+}
+
+impl Default for MicroBatchOptions {
+    fn default() -> Self {
+        Self {
+            workers: 0,
+            max_wait: DEFAULT_MAX_WAIT,
+            max_batch: DEFAULT_MAX_BATCH,
+            parse: ParseOptions::default(),
+        }
+    }
+}
+
+impl MicroBatchOptions {
+    /// Set the number of batching threads (`0` = one per available core).
+    #[must_use]
+    pub const fn workers(mut self, workers: usize) -> Self {
+        self.workers = workers;
+        self
+    }
+
+    /// Set the longest a request waits for others to join its batch.
+    #[must_use]
+    pub const fn max_wait(mut self, max_wait: Duration) -> Self {
+        self.max_wait = max_wait;
+        self
+    }
+
+    /// Set the most requests in one batch.
+    #[must_use]
+    pub const fn max_batch(mut self, max_batch: usize) -> Self {
+        self.max_batch = max_batch;
+        self
+    }
+
+    /// Set the options for the parser of each request.
+    #[must_use]
+    pub const fn parse_options(mut self, parse: ParseOptions) -> Self {
+        self.parse = parse;
+        self
+    }
+}
+
+/// Counters of a [`MicroBatcher`], see [`MicroBatcher::stats`].
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct MicroBatchStats {
+    /// Number of requests processed.
+    pub requests: u64,
+    /// Number of batches processed.
+    pub batches: u64,
+    /// Number of sentences tokenized, including those of failed requests.
+    pub sentences: u64,
+    /// Total time requests spent queued before their batch started.
+    pub queue_total: Duration,
+    /// Longest time a request spent queued before its batch started.
+    pub queue_max: Duration,
+}
+
+impl MicroBatchStats {
+    /// Mean time a request spent queued before its batch started.
+    #[must_use]
+    pub fn queue_mean(&self) -> Duration {
+        u32::try_from(self.requests)
+            .ok()
+            .and_then(|requests| self.queue_total.checked_div(requests))
+            .unwrap_or_default()
+    }
+}
+
+/// A document waiting to be batched.
+#[derive(Debug)]
+struct Request {
+    /// The document.
+    text: String,
+    /// When the request was queued.
+    queued: Instant,
+    /// Where its result goes.
+    reply: SyncSender<Result<Vec<Sentence>, UdpipeError>>,
+}
+
+/// Requests waiting for a batching thread.
+#[derive(Debug, Default)]
+struct Requests {
+    /// Requests in arrival order.
+    pending: VecDeque<Request>,
+    /// Whether the batcher was dropped; threads exit once `pending` is empty.
+    shutdown: bool,
+}
+
+/// State shared by a [`MicroBatcher`] and its threads.
+#[derive(Debug, Default)]
+struct Shared {
+    /// The requests.
+    requests: Mutex<Requests>,
+    /// Signalled when requests arrive or the batcher shuts down.
+    ready: Condvar,
+    /// Counters over all threads.
+    stats: Mutex<MicroBatchStats>,
+}
+
+impl Shared {
+    /// Wait for the next batch: at most `max_batch` requests, taken once
+    /// there are that many or the oldest has waited `max_wait`. Returns
+    /// `None` once the batcher is shut down and the queue is empty.
+    fn take_batch(&self, max_wait: Duration, max_batch: usize) -> Option<Vec<Request>> {
+        let mut requests = lock(&self.requests);
+        loop {
+            let Some(oldest) = requests.pending.front() else {
+                if requests.shutdown {
+                    return None;
+                }
+                requests = self
+                    .ready
+                    .wait(requests)
+                    .unwrap_or_else(PoisonError::into_inner);
+                continue;
+            };
+            let waited = oldest.queued.elapsed();
+            if requests.pending.len() >= max_batch || waited >= max_wait || requests.shutdown {
+                break;
+            }
+            requests = self
+                .ready
+                .wait_timeout(requests, max_wait - waited)
+                .unwrap_or_else(PoisonError::into_inner)
+                .0;
+        }
+        let count = requests.pending.len().min(max_batch);
+        Some(requests.pending.drain(..count).collect())
+    }
+}
+
+/// A batching thread's view of its model and parser.
+struct Worker<'m> {
+    /// The shared model.
+    model: &'m Model,
+    /// Tokenizer reused for every request.
+    parser: ReusableParser<'m>,
+}
+
+impl Worker<'_> {
+    /// Process `batch` one stage at a time: tokenize every request, then tag
+    /// every sentence, then parse every sentence. Returns the result of each
+    /// request and the number of sentences.
+    fn run(&mut self, batch: &[Request]) -> (Vec<Result<Vec<Sentence>, UdpipeError>>, u64) {
+        let mut results: Vec<Result<Vec<Sentence>, UdpipeError>> =
+            std::iter::repeat_with(|| Ok(Vec::new()))
+                .take(batch.len())
+                .collect();
+        let mut sentences: Vec<(usize, RawSentence)> = Vec::new();
+        for (index, request) in batch.iter().enumerate() {
+            let tokenized = self.parser.parse(&request.text).and_then(|mut document| {
+                while let Some(raw) = document.next_raw() {
+                    sentences.push((index, raw?));
+                }
+                Ok(())
+            });
+            if let Err(err) = tokenized {
+                results[index] = Err(err);
+            }
+        }
+        for (index, raw) in &mut sentences {
+            if results[*index].is_ok() {
+                results[*index] = raw.tag(self.model).map(|()| Vec::new());
+            }
+        }
+        for (index, raw) in &mut sentences {
+            if results[*index].is_ok() {
+                results[*index] = raw.parse(self.model).map(|()| Vec::new());
+            }
+        }
+        let count = sentences.len() as u64;
+        for (index, raw) in sentences {
+            if let Ok(parsed) = &mut results[index] {
+                parsed.push(raw.into_sentence());
+            }
+        }
+        (results, count)
+    }
+}
+
+/// A scheduler that parses many concurrent small requests in batches.
+///
+/// Each call to [`MicroBatcher::parse`] queues its text and blocks. A batching
+/// thread waits up to [`MicroBatchOptions::max_wait`] for more requests to
+/// arrive, then tokenizes the whole batch on one reused tokenizer and runs
+/// the tagger over all its sentences, then the dependency parser, before
+/// handing each caller its sentences. Compared with one parser per request,
+/// this saves the per-call setup of a tokenizer and keeps each model stage hot
+/// in cache across the batch, at the cost of up to `max_wait` extra latency.
+/// [`MicroBatcher::stats`] reports how long requests actually waited.
+///
+/// The batcher is `Sync`: share it between threads with an [`Arc`] or by
+/// reference. Dropping it finishes queued requests, then joins its threads.
+///
+/// # Example
+/// ```no_run
+/// use std::sync::Arc;
+/// use udpipe_rs::{MicroBatchOptions, MicroBatcher, Model};
+///
+/// let model = Model::load("english-ewt-ud-2.5-191206.udpipe").expect("Failed to load");
+/// let batcher = MicroBatcher::new(Arc::new(model), MicroBatchOptions::default().workers(1))
+///     .expect("Failed to start batcher");
+/// std::thread::scope(|s| {
+///     for query in ["first query", "second query"] {
+///         let batcher = &batcher;
+///         s.spawn(move || batcher.parse(query).expect("Failed to parse"));
+///     }
+/// });
+/// println!("mean queueing: {:?}", batcher.stats().queue_mean());
+/// ```
+#[derive(Debug)]
+pub struct MicroBatcher {
+    /// State shared with the threads.
+    shared: Arc<Shared>,
+    /// The batching threads.
+    workers: Vec<JoinHandle<()>>,
+}
+
+impl MicroBatcher {
+    /// Start a batcher with its threads, each holding a tokenizer for `model`.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if a thread's parser cannot be created.
+    pub fn new(model: Arc<Model>, options: MicroBatchOptions) -> Result<Self, UdpipeError> {
+        let workers = if options.workers == 0 {
+            std::thread::available_parallelism().map_or(1, std::num::NonZeroUsize::get)
+        } else {
+            options.workers
+        };
+        let max_batch = options.max_batch.max(1);
+        let shared = Arc::new(Shared::default());
+        let (started_tx, started_rx) = mpsc::channel();
+        let mut batcher = Self {
+            shared: Arc::clone(&shared),
+            workers: Vec::with_capacity(workers),
+        };
+        for model in std::iter::repeat_n(model, workers) {
+            let (shared, started_tx) = (Arc::clone(&shared), started_tx.clone());
+            batcher.workers.push(std::thread::spawn(move || {
+                let mut worker = match model.reusable_parser_with_options(options.parse) {
+                    Ok(parser) => Worker {
+                        model: &model,
+                        parser,
+                    },
+                    Err(err) => {
+                        drop(started_tx.send(Err(err)));
+                        return;
+                    }
+                };
+                drop(started_tx.send(Ok(())));
+                // `new` waits until every thread has dropped its sender.
+                drop(started_tx);
+                while let Some(batch) = shared.take_batch(options.max_wait, max_batch) {
+                    let started = Instant::now();
+                    let (results, sentences) = worker.run(&batch);
+                    {
+                        let mut stats = lock(&shared.stats);
+                        stats.batches += 1;
+                        stats.sentences += sentences;
+                        for request in &batch {
+                            let queued = started.saturating_duration_since(request.queued);
+                            stats.requests += 1;
+                            stats.queue_total += queued;
+                            stats.queue_max = stats.queue_max.max(queued);
+                        }
+                    }
+                    for (request, result) in batch.into_iter().zip(results) {
+                        // The caller may have gone away; nothing to deliver then.
+                        drop(request.reply.send(result));
+                    }
+                }
+            }));
+        }
+        drop(started_tx);
+        // On error, dropping `batcher` stops the threads that did start.
+        for started in started_rx {
+            started?;
+        }
+        Ok(batcher)
+    }
+
+    /// Parse `text` as part of the next batch, blocking until it is done.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if parsing the document fails; other requests of the
+    /// same batch are not affected.
+    pub fn parse(&self, text: impl Into<String>) -> Result<Vec<Sentence>, UdpipeError> {
+        let (reply, result) = mpsc::sync_channel(1);
+        lock(&self.shared.requests).pending.push_back(Request {
+            text: text.into(),
+            queued: Instant::now(),
+            reply,
+        });
+        self.shared.ready.notify_one();
+        result.recv().unwrap_or_else(|_| {
+            Err(UdpipeError::new(
+                UdpipeErrorKind::ParseError,
+                "Batching thread stopped",
+            ))
+        })
+    }
+
+    /// Counters over all requests so far, including queueing latency.
+    #[must_use]
+    pub fn stats(&self) -> MicroBatchStats {
+        *lock(&self.shared.stats)
+    }
+}
+
+impl Drop for MicroBatcher {
+    fn drop(&mut self) {
+        lock(&self.shared.requests).shutdown = true;
+        self.shared.ready.notify_all();
+        for worker in self.workers.drain(..) {
+            // A panicking thread has already reported its panic.
+            drop(worker.join());
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// A request for `text` queued `age` ago, whose result is discarded.
+    fn request(text: &str, age: Duration) -> Request {
+        Request {
+            text: text.to_owned(),
+            queued: Instant::now().checked_sub(age).unwrap_or_else(Instant::now),
+            reply: mpsc::sync_channel(1).0,
+        }
+    }
+
+    #[test]
+    fn test_micro_batch_options_builder() {
+        let options = MicroBatchOptions::default()
+            .workers(2)
+            .max_wait(Duration::from_millis(1))
+            .max_batch(8);
+        assert_eq!(options.workers, 2);
+        assert_eq!(options.max_wait, Duration::from_millis(1));
+        assert_eq!(options.max_batch, 8);
+        assert_eq!(MicroBatchOptions::default().max_wait, DEFAULT_MAX_WAIT);
+    }
+
+    #[test]
+    fn test_micro_batch_stats_means() {
+        let stats = MicroBatchStats {
+            requests: 6,
+            batches: 2,
+            sentences: 9,
+            queue_total: Duration::from_micros(600),
+            queue_max: Duration::from_micros(200),
+        };
+        assert_eq!(stats.queue_mean(), Duration::from_micros(100));
+        assert_eq!(MicroBatchStats::default().queue_mean(), Duration::ZERO);
+    }
+
+    #[test]
+    fn test_take_batch_waits_for_full_batch_or_deadline() {
+        let shared = Shared::default();
+        for text in ["a", "b", "c"] {
+            lock(&shared.requests)
+                .pending
+                .push_back(request(text, Duration::ZERO));
+        }
+        // Full: taken at once, without waiting out the hour.
+        let batch = shared.take_batch(Duration::from_secs(3600), 2).unwrap();
+        assert_eq!(
+            batch.iter().map(|r| r.text.as_str()).collect::<Vec<_>>(),
+            ["a", "b"]
+        );
+
+        // Not full: taken once the oldest request has waited long enough.
+        let start = Instant::now();
+        let batch = shared.take_batch(Duration::from_millis(5), 2).unwrap();
+        assert_eq!(batch.len(), 1);
+        assert!(start.elapsed() >= Duration::from_millis(4));
+
+        lock(&shared.requests)
+            .pending
+            .push_back(request("old", Duration::from_secs(1)));
+        assert_eq!(
+            shared
+                .take_batch(Duration::from_millis(1), 8)
+                .unwrap()
+                .len(),
+            1
+        );
+
+        lock(&shared.requests).shutdown = true;
+        assert!(shared.take_batch(Duration::from_secs(3600), 8).is_none());
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_micro_batcher_with_null_model() {
+        let model = Model {
+            inner: std::ptr::null_mut(),
+        };
+        let err = MicroBatcher::new(Arc::new(model), MicroBatchOptions::default().workers(2))
+            .unwrap_err();
+        assert!(err.message.contains("Invalid arguments"));
+    }
+}
@@ -0,0 +1,671 @@
+//! An async front-end (the `async` feature): a dedicated pool of parsing
+//! threads that async tasks hand documents to without blocking their executor.
+
+use std::collections::VecDeque;
+use std::future::Future;
+use std::pin::Pin;
+use std::sync::mpsc;
+use std::sync::{Arc, Condvar, Mutex, PoisonError};
+use std::task::{Context, Poll, Waker};
+use std::thread::JoinHandle;
+
+use futures_core::Stream;
+
+use crate::{Model, ParseOptions, ReusableParser, Sentence, UdpipeError, UdpipeErrorKind, lock};
+
+/// Default for [`AsyncOptions::max_coalesce`].
+const DEFAULT_MAX_COALESCE: usize = 16;
+
+/// Options for [`ParseService::new`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct AsyncOptions {
+    /// Number of parsing threads. `0` uses
+    /// [`std::thread::available_parallelism`].
+    pub workers: usize,
+    /// Most queued requests a thread takes at once. A thread woken while
+    /// requests pile up takes its share of them (up to this many) in one go
+    /// and parses them back to back on its reused parser, instead of waking
+    /// once per request. Values below 1 are treated as 1.
+    pub max_coalesce: usize,
+    /// Options for the parser of each request.
+    pub parse: ParseOptions,
+}
+
+impl Default for AsyncOptions {
+    fn default() -> Self {
+        Self {
+            workers: 0,
+            max_coalesce: DEFAULT_MAX_COALESCE,
+            parse: ParseOptions::default(),
+        }
+    }
+}
+
+impl AsyncOptions {
+    /// Set the number of parsing threads (`0` = one per available core).
+    #[must_use]
+    pub const fn workers(mut self, workers: usize) -> Self {
+        self.workers = workers;
+        self
+    }
+
+    /// Set the most queued requests a thread takes at once.
+    #[must_use]
+    pub const fn max_coalesce(mut self, max_coalesce: usize) -> Self {
+        self.max_coalesce = max_coalesce;
+        self
+    }
+
+    /// Set the options for the parser of each request.
+    #[must_use]
+    pub const fn parse_options(mut self, parse: ParseOptions) -> Self {
+        self.parse = parse;
+        self
+    }
+}
+
+/// State shared by a [`SentenceStream`] and the thread filling it.
+#[derive(Debug, Default)]
+struct StreamState {
+    /// Sentences parsed but not yet yielded.
+    sentences: VecDeque<Result<Sentence, UdpipeError>>,
+    /// Whether the document is fully parsed.
+    done: bool,
+    /// Whether the stream was dropped, so parsing can stop.
+    closed: bool,
+    /// Task to wake when a sentence arrives or the document ends.
+    waker: Option<Waker>,
+}
+
+impl StreamState {
+    /// Queue `sentence`, or end the document if `sentence` is `None`, and wake
+    /// the reader. Returns `false` if the stream was dropped.
+    fn send(state: &Mutex<Self>, sentence: Option<Result<Sentence, UdpipeError>>) -> bool {
+        let waker = {
+            let mut state = lock(state);
+            if state.closed {
+                return false;
+            }
+            match sentence {
+                Some(sentence) => state.sentences.push_back(sentence),
+                None => state.done = true,
+            }
+            state.waker.take()
+        };
+        if let Some(waker) = waker {
+            waker.wake();
+        }
+        true
+    }
+}
+
+/// The sentences of one document parsed by a [`ParseService`], in order.
+///
+/// Returned by [`ParseService::parse`]. Like [`Parser`](crate::Parser), it
+/// ends after the first error. Dropping it stops parsing the rest of the
+/// document.
+#[derive(Debug)]
+pub struct SentenceStream {
+    /// Shared with the parsing thread.
+    state: Arc<Mutex<StreamState>>,
+}
+
+impl Stream for SentenceStream {
+    type Item = Result<Sentence, UdpipeError>;
+
+    fn poll_next(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Option<Self::Item>> {
+        let mut state = lock(&self.state);
+        if let Some(sentence) = state.sentences.pop_front() {
+            return Poll::Ready(Some(sentence));
+        }
+        if state.done {
+            return Poll::Ready(None);
+        }
+        state.waker = Some(cx.waker().clone());
+        Poll::Pending
+    }
+}
+
+impl Drop for SentenceStream {
+    fn drop(&mut self) {
+        let mut state = lock(&self.state);
+        state.closed = true;
+        state.sentences.clear();
+    }
+}
+
+/// State shared by a [`BatchFuture`] and the threads filling it.
+#[derive(Debug, Default)]
+struct BatchState {
+    /// Result of each document, once parsed.
+    results: Vec<Option<Result<Vec<Sentence>, UdpipeError>>>,
+    /// Number of documents not yet parsed.
+    remaining: usize,
+    /// Task to wake when the last document is parsed.
+    waker: Option<Waker>,
+}
+
+impl BatchState {
+    /// Store the result of document `index`. Returns the task to wake if it
+    /// was the last one.
+    fn complete(
+        &mut self,
+        index: usize,
+        result: Result<Vec<Sentence>, UdpipeError>,
+    ) -> Option<Waker> {
+        self.results[index] = Some(result);
+        self.remaining -= 1;
+        if self.remaining > 0 {
+            return None;
+        }
+        self.waker.take()
+    }
+
+    /// Store the result of document `index` and wake the task if it was the
+    /// last one.
+    fn deliver(state: &Mutex<Self>, index: usize, result: Result<Vec<Sentence>, UdpipeError>) {
+        let waker = lock(state).complete(index, result);
+        if let Some(waker) = waker {
+            waker.wake();
+        }
+    }
+}
+
+/// The results of [`ParseService::parse_batch`]: one entry per document, in
+/// input order.
+#[derive(Debug)]
+#[must_use = "futures do nothing unless awaited"]
+pub struct BatchFuture {
+    /// Shared with the parsing threads.
+    state: Arc<Mutex<BatchState>>,
+}
+
+impl Future for BatchFuture {
+    type Output = Vec<Result<Vec<Sentence>, UdpipeError>>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        let mut state = lock(&self.state);
+        if state.remaining > 0 {
+            state.waker = Some(cx.waker().clone());
+            return Poll::Pending;
+        }
+        Poll::Ready(
+            std::mem::take(&mut state.results)
+                .into_iter()
+                .flatten()
+                .collect(),
+        )
+    }
+}
+
+/// Where the result of a request goes.
+#[derive(Debug)]
+enum Output {
+    /// Each sentence to a [`SentenceStream`].
+    Stream(Arc<Mutex<StreamState>>),
+    /// All sentences, as one entry of a [`BatchFuture`].
+    Batch(Arc<Mutex<BatchState>>, usize),
+}
+
+/// A document waiting to be parsed.
+#[derive(Debug)]
+struct Request {
+    /// The document.
+    text: String,
+    /// Where its sentences go.
+    output: Output,
+}
+
+impl Request {
+    /// Parse the document with `parser` and deliver the result.
+    fn run(&self, parser: &mut ReusableParser<'_>) {
+        match &self.output {
+            Output::Stream(state) => {
+                match parser.parse(&self.text) {
+                    Ok(document) => {
+                        for sentence in document {
+                            let failed = sentence.is_err();
+                            if !StreamState::send(state, Some(sentence)) || failed {
+                                break;
+                            }
+                        }
+                    }
+                    Err(err) => {
+                        StreamState::send(state, Some(Err(err)));
+                    }
+                }
+                StreamState::send(state, None);
+            }
+            Output::Batch(state, index) => {
+                let result = parser.parse(&self.text).and_then(Iterator::collect);
+                BatchState::deliver(state, *index, result);
+            }
+        }
+    }
+
+    /// Deliver an error in place of the rest of the result: the stream ends
+    /// with it, or it becomes the document's batch entry.
+    fn fail(&self) {
+        let err = || UdpipeError::new(UdpipeErrorKind::ParseError, "Parsing thread stopped");
+        match &self.output {
+            Output::Stream(state) => {
+                StreamState::send(state, Some(Err(err())));
+                StreamState::send(state, None);
+            }
+            Output::Batch(state, index) => BatchState::deliver(state, *index, Err(err())),
+        }
+    }
+}
+
+/// Requests taken by a parsing thread, failed when dropped unless they were
+/// run, so that a panic does not leave their futures and streams waiting
+/// forever.
+struct Taken(VecDeque<Request>);
+
+impl Taken {
+    /// Run the requests in order, each removed only once it has completed.
+    fn run(mut self, parser: &mut ReusableParser<'_>) {
+        while let Some(request) = self.0.front() {
+            request.run(parser);
+            self.0.pop_front();
+        }
+    }
+}
+
+impl Drop for Taken {
+    fn drop(&mut self) {
+        for request in &self.0 {
+            request.fail();
+        }
+    }
+}
+
+/// Counts a parsing thread as gone when dropped, even if it panicked. When
+/// the last one goes, the requests still queued are failed, since no thread
+/// would take them.
+struct Exit<'q>(&'q Queue);
+
+impl Drop for Exit<'_> {
+    fn drop(&mut self) {
+        let orphaned = {
+            let mut queue = lock(&self.0.requests);
+            queue.live -= 1;
+            if queue.live > 0 {
+                return;
+            }
+            std::mem::take(&mut queue.pending)
+        };
+        drop(Taken(orphaned));
+    }
+}
+
+/// Requests waiting for a parsing thread.
+#[derive(Debug, Default)]
+struct Requests {
+    /// Requests in arrival order.
+    pending: VecDeque<Request>,
+    /// Whether the service was dropped; threads exit once `pending` is empty.
+    shutdown: bool,
+    /// Number of threads still taking requests.
+    live: usize,
+}
+
+/// The queue between a [`ParseService`] and its threads.
+#[derive(Debug, Default)]
+struct Queue {
+    /// The requests.
+    requests: Mutex<Requests>,
+    /// Signalled when requests arrive or the service shuts down.
+    ready: Condvar,
+}
+
+impl Queue {
+    /// Add `requests` and wake enough threads to handle them. With no thread
+    /// left, the requests are failed instead.
+    fn push(&self, requests: impl IntoIterator<Item = Request>) {
+        let added = {
+            let mut queue = lock(&self.requests);
+            if queue.live == 0 {
+                drop(queue);
+                drop(Taken(requests.into_iter().collect()));
+                return;
+            }
+            let before = queue.pending.len();
+            queue.pending.extend(requests);
+            queue.pending.len() - before
+        };
+        match added {
+            0 => {}
+            1 => self.ready.notify_one(),
+            _ => self.ready.notify_all(),
+        }
+    }
+
+    /// Wait for requests and take a share of them: the pending requests
+    /// divided evenly among `workers`, at most `max`. Returns `None` once the
+    /// service is shut down and the queue is empty.
+    fn take(&self, workers: usize, max: usize) -> Option<Taken> {
+        let mut queue = lock(&self.requests);
+        while queue.pending.is_empty() {
+            if queue.shutdown {
+                return None;
+            }
+            queue = self
+                .ready
+                .wait(queue)
+                .unwrap_or_else(PoisonError::into_inner);
+        }
+        let count = queue.pending.len().div_ceil(workers).min(max);
+        Some(Taken(queue.pending.drain(..count).collect()))
+    }
+}
+
+/// A pool of parsing threads sharing one [`Model`], for use from async code.
+///
+/// Parsing is CPU-bound and blocks; calling [`Parser`](crate::Parser) from an
+/// async task stalls the executor, and `spawn_blocking` for every short
+/// request costs more than parsing it. A `ParseService` instead keeps a fixed
+/// set of threads, each with its own [`ReusableParser`], and hands them
+/// requests through a queue. The futures it returns are runtime-agnostic:
+/// they are woken by the parsing threads and work with tokio or any other
+/// executor.
+///
+/// Dropping the service waits for queued requests to finish, then joins its
+/// threads.
+///
+/// # Panics
+///
+/// If a parsing thread panics, the requests it had taken fail with an error,
+/// as do all queued and later requests once no thread is left. Dropping the
+/// service then resumes the panic on the dropping thread.
+///
+/// # Example
+/// ```no_run
+/// use std::sync::Arc;
+/// use udpipe_rs::{AsyncOptions, Model, ParseService};
+///
+/// # async fn run() {
+/// let model = Model::load("english-ewt-ud-2.5-191206.udpipe").expect("Failed to load");
+/// let service = ParseService::new(Arc::new(model), AsyncOptions::default())
+///     .expect("Failed to start service");
+/// let results = service.parse_batch(["First request.", "Second request."]).await;
+/// for sentences in results {
+///     println!("{} sentences", sentences.expect("Failed to parse").len());
+/// }
+/// # }
+/// ```
+#[derive(Debug)]
+pub struct ParseService {
+    /// Queue shared with the threads.
+    queue: Arc<Queue>,
+    /// The parsing threads.
+    workers: Vec<JoinHandle<()>>,
+}
+
+impl ParseService {
+    /// Start a service with its threads, each holding a parser for `model`.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if a thread's parser cannot be created.
+    pub fn new(model: Arc<Model>, options: AsyncOptions) -> Result<Self, UdpipeError> {
+        let workers = if options.workers == 0 {
+            std::thread::available_parallelism().map_or(1, std::num::NonZeroUsize::get)
+        } else {
+            options.workers
+        };
+        let max_coalesce = options.max_coalesce.max(1);
+        let queue = Arc::new(Queue::default());
+        lock(&queue.requests).live = workers;
+        let (started_tx, started_rx) = mpsc::channel();
+        let mut service = Self {
+            queue: Arc::clone(&queue),
+            workers: Vec::with_capacity(workers),
+        };
+        for model in std::iter::repeat_n(model, workers) {
+            let (queue, started_tx) = (Arc::clone(&queue), started_tx.clone());
+            service.workers.push(std::thread::spawn(move || {
+                let _exit = Exit(&queue);
+                let mut parser = match model.reusable_parser_with_options(options.parse) {
+                    Ok(parser) => parser,
+                    Err(err) => {
+                        drop(started_tx.send(Err(err)));
+                        return;
+                    }
+                };
+                drop(started_tx.send(Ok(())));
+                // `new` waits until every thread has dropped its sender.
+                drop(started_tx);
+                while let Some(requests) = queue.take(workers, max_coalesce) {
+                    requests.run(&mut parser);
+                }
+            }));
+        }
+        drop(started_tx);
+        // On error, dropping `service` stops the threads that did start.
+        for started in started_rx {
+            started?;
+        }
+        Ok(service)
+    }
+
+    /// Parse `text`, yielding its sentences as they are parsed.
+    pub fn parse(&self, text: impl Into<String>) -> SentenceStream {
+        let state = Arc::new(Mutex::new(StreamState::default()));
+        self.queue.push(std::iter::once(Request {
+            text: text.into(),
+            output: Output::Stream(Arc::clone(&state)),
+        }));
+        SentenceStream { state }
+    }
+
+    /// Parse many documents, spread over the threads.
+    ///
+    /// The returned future resolves to one entry per document, in input
+    /// order; a failing document does not affect the others.
+    pub fn parse_batch<I>(&self, texts: I) -> BatchFuture
+    where
+        I: IntoIterator,
+        I::Item: Into<String>,
+    {
+        let texts: Vec<String> = texts.into_iter().map(Into::into).collect();
+        let state = Arc::new(Mutex::new(BatchState {
+            results: std::iter::repeat_with(|| None).take(texts.len()).collect(),
+            remaining: texts.len(),
+            waker: None,
+        }));
+        self.queue
+            .push(texts.into_iter().enumerate().map(|(index, text)| Request {
+                text,
+                output: Output::Batch(Arc::clone(&state), index),
+            }));
+        BatchFuture { state }
+    }
+}
+
+impl Drop for ParseService {
+    fn drop(&mut self) {
+        lock(&self.queue.requests).shutdown = true;
+        self.queue.ready.notify_all();
+        let mut panic = None;
+        for worker in self.workers.drain(..) {
+            if let Err(payload) = worker.join() {
+                panic.get_or_insert(payload);
+            }
+        }
+        // Resuming while already unwinding would abort the process.
+        if let Some(payload) = panic.filter(|_| !std::thread::panicking()) {
+            std::panic::resume_unwind(payload);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use std::sync::atomic::{AtomicBool, Ordering};
+    use std::task::Wake;
+
+    use super::*;
+
+    /// A waker that records that it was woken.
+    #[derive(Debug, Default)]
+    struct Flag(AtomicBool);
+
+    impl Wake for Flag {
+        fn wake(self: Arc<Self>) {
+            self.0.store(true, Ordering::SeqCst);
+        }
+    }
+
+    /// A sentence identified by its comment.
+    fn sentence(comment: &str) -> Sentence {
+        Sentence {
+            words: Vec::new(),
+            multiword_tokens: Vec::new(),
+            comments: vec![comment.to_owned()],
+        }
+    }
+
+    #[test]
+    fn test_async_options_builder() {
+        let options = AsyncOptions::default().workers(2).max_coalesce(4);
+        assert_eq!(options.workers, 2);
+        assert_eq!(options.max_coalesce, 4);
+        assert_eq!(AsyncOptions::default().max_coalesce, DEFAULT_MAX_COALESCE);
+    }
+
+    #[test]
+    fn test_sentence_stream_wakes_and_ends() {
+        let state = Arc::new(Mutex::new(StreamState::default()));
+        let mut stream = SentenceStream {
+            state: Arc::clone(&state),
+        };
+        let flag = Arc::new(Flag::default());
+        let waker = Waker::from(Arc::clone(&flag));
+        let mut cx = Context::from_waker(&waker);
+
+        assert!(Pin::new(&mut stream).poll_next(&mut cx).is_pending());
+        assert!(StreamState::send(&state, Some(Ok(sentence("a")))));
+        assert!(flag.0.load(Ordering::SeqCst));
+        let Poll::Ready(Some(Ok(first))) = Pin::new(&mut stream).poll_next(&mut cx) else {
+            panic!("expected a sentence");
+        };
+        assert_eq!(first.comments, ["a"]);
+        assert!(StreamState::send(&state, None));
+        assert!(matches!(
+            Pin::new(&mut stream).poll_next(&mut cx),
+            Poll::Ready(None)
+        ));
+
+        drop(stream);
+        assert!(!StreamState::send(&state, Some(Ok(sentence("b")))));
+    }
+
+    #[test]
+    fn test_batch_future_resolves_in_input_order() {
+        let state = Arc::new(Mutex::new(BatchState {
+            results: vec![None, None],
+            remaining: 2,
+            waker: None,
+        }));
+        let mut future = BatchFuture {
+            state: Arc::clone(&state),
+        };
+        let flag = Arc::new(Flag::default());
+        let waker = Waker::from(Arc::clone(&flag));
+        let mut cx = Context::from_waker(&waker);
+
+        assert!(Pin::new(&mut future).poll(&mut cx).is_pending());
+        let waker = lock(&state).complete(1, Ok(vec![sentence("second")]));
+        assert!(waker.is_none());
+        let waker = lock(&state).complete(0, Ok(vec![sentence("first")]));
+        waker.unwrap().wake();
+        assert!(flag.0.load(Ordering::SeqCst));
+        let Poll::Ready(results) = Pin::new(&mut future).poll(&mut cx) else {
+            panic!("expected the results");
+        };
+        let comments: Vec<_> = results
+            .into_iter()
+            .map(|result| result.unwrap()[0].comments[0].clone())
+            .collect();
+        assert_eq!(comments, ["first", "second"]);
+    }
+
+    #[test]
+    fn test_queue_shares_requests_among_workers() {
+        let queue = Queue::default();
+        lock(&queue.requests).live = 1;
+        let state = Arc::new(Mutex::new(StreamState::default()));
+        queue.push((0..10).map(|i| Request {
+            text: i.to_string(),
+            output: Output::Stream(Arc::clone(&state)),
+        }));
+        assert_eq!(queue.take(4, 16).map(|taken| taken.0.len()), Some(3));
+        assert_eq!(queue.take(1, 2).map(|taken| taken.0.len()), Some(2));
+        assert_eq!(queue.take(1, 16).map(|taken| taken.0.len()), Some(5));
+        lock(&queue.requests).shutdown = true;
+        assert!(queue.take(1, 16).is_none());
+    }
+
+    #[test]
+    fn test_panicking_thread_fails_its_requests() {
+        let queue = Queue::default();
+        lock(&queue.requests).live = 1;
+        let stream = Arc::new(Mutex::new(StreamState::default()));
+        let batch = Arc::new(Mutex::new(BatchState {
+            results: vec![None, None],
+            remaining: 2,
+            waker: None,
+        }));
+        queue.push([
+            Request {
+                text: "taken".to_owned(),
+                output: Output::Stream(Arc::clone(&stream)),
+            },
+            Request {
+                text: "taken".to_owned(),
+                output: Output::Batch(Arc::clone(&batch), 0),
+            },
+            Request {
+                text: "queued".to_owned(),
+                output: Output::Batch(Arc::clone(&batch), 1),
+            },
+        ]);
+
+        let panicked = std::panic::catch_unwind(|| {
+            let _exit = Exit(&queue);
+            let _taken = queue.take(1, 2);
+            panic!("parsing failed");
+        });
+        assert!(panicked.is_err());
+        assert!(lock(&stream).done);
+        assert!(matches!(lock(&stream).sentences.front(), Some(Err(_))));
+        assert_eq!(lock(&batch).remaining, 0);
+        assert!(
+            lock(&batch)
+                .results
+                .iter()
+                .all(|result| matches!(result, Some(Err(_))))
+        );
+
+        // With no thread left, a new request fails at once.
+        let late = Arc::new(Mutex::new(StreamState::default()));
+        queue.push(std::iter::once(Request {
+            text: "late".to_owned(),
+            output: Output::Stream(Arc::clone(&late)),
+        }));
+        assert!(lock(&late).done);
+        assert!(lock(&queue.requests).pending.is_empty());
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_parse_service_with_null_model() {
+        let model = Model {
+            inner: std::ptr::null_mut(),
+        };
+        let err =
+            ParseService::new(Arc::new(model), AsyncOptions::default().workers(2)).unwrap_err();
+        assert!(err.message.contains("Invalid arguments"));
+    }
+}
@@ -0,0 +1,150 @@
+//! Per-stage timing and throughput counters for parsers and models.
+
+use std::time::{Duration, Instant};
+
+use crate::{Model, Parser, ffi};
+
+/// Time spent in each stage of the `UDPipe` pipeline, plus throughput counts.
+///
+/// Collected only while enabled with [`Model::set_stats_enabled`]; see
+/// [`Parser::stats`] and [`Model::stats`].
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ParseStats {
+    /// Time spent splitting text into sentences and tokens.
+    pub tokenize: Duration,
+    /// Time spent tagging and lemmatizing.
+    pub tag: Duration,
+    /// Time spent in the dependency parser.
+    pub parse: Duration,
+    /// Time spent building results and converting them into owned
+    /// [`Sentence`](crate::Sentence)s.
+    pub build: Duration,
+    /// Number of sentences fully processed.
+    pub sentences: u64,
+    /// Number of words tokenized.
+    pub words: u64,
+    /// Number of bytes of input text.
+    pub bytes: u64,
+}
+
+impl ParseStats {
+    /// Total time across all stages.
+    #[must_use]
+    pub fn total(&self) -> Duration {
+        self.tokenize + self.tag + self.parse + self.build
+    }
+
+    /// Convert the counters reported by the C++ wrapper.
+    const fn from_ffi(stats: ffi::UdpipeStats) -> Self {
+        Self {
+            tokenize: Duration::from_nanos(stats.tokenize_ns),
+            tag: Duration::from_nanos(stats.tag_ns),
+            parse: Duration::from_nanos(stats.parse_ns),
+            build: Duration::from_nanos(stats.build_ns),
+            sentences: stats.sentences,
+            words: stats.words,
+            bytes: stats.bytes,
+        }
+    }
+}
+
+/// Nanoseconds elapsed since `start`, saturating at `u64::MAX`.
+pub fn elapsed_ns(start: Instant) -> u64 {
+    u64::try_from(start.elapsed().as_nanos()).unwrap_or(u64::MAX)
+}
+
+impl Model {
+    /// Turn per-stage stats collection on or off.
+    ///
+    /// Collection is off by default; while off, no clocks are read. The
+    /// setting applies to parsers created afterwards.
+    ///
+    /// # Example
+    /// ```no_run
+    /// use udpipe_rs::Model;
+    ///
+    /// let model = Model::load("english-ewt-ud-2.5-191206.udpipe").expect("Failed to load");
+    /// model.set_stats_enabled(true);
+    /// for sentence in model.parser("The quick brown fox.").expect("Failed to create parser") {
+    ///     sentence.expect("Failed to parse sentence");
+    /// }
+    /// let stats = model.stats();
+    /// println!("tag: {:?}, parse: {:?}", stats.tag, stats.parse);
+    /// ```
+    pub fn set_stats_enabled(&self, enabled: bool) {
+        // SAFETY: `self.inner` is a valid model (or null, which is a no-op).
+        unsafe { ffi::udpipe_model_set_stats_enabled(self.inner, enabled) };
+    }
+
+    /// Whether per-stage stats collection is on.
+    #[must_use]
+    pub fn stats_enabled(&self) -> bool {
+        // SAFETY: `self.inner` is a valid model (or null).
+        unsafe { ffi::udpipe_model_stats_enabled(self.inner) }
+    }
+
+    /// Stats accumulated over every parser of this model, on all threads,
+    /// since loading or the last [`Model::reset_stats`].
+    ///
+    /// This includes [`Model::parallel_parser`] and [`Model::pipelined_parser`].
+    /// Stage times are summed over threads, so with concurrent parsers they can
+    /// exceed wall-clock time.
+    #[must_use]
+    pub fn stats(&self) -> ParseStats {
+        // SAFETY: `self.inner` is a valid model (or null).
+        ParseStats::from_ffi(unsafe { ffi::udpipe_model_get_stats(self.inner) })
+    }
+
+    /// Reset the totals returned by [`Model::stats`] to zero.
+    pub fn reset_stats(&self) {
+        // SAFETY: `self.inner` is a valid model (or null, which is a no-op).
+        unsafe { ffi::udpipe_model_reset_stats(self.inner) };
+    }
+}
+
+impl Parser<'_> {
+    /// Stats of this parser so far.
+    ///
+    /// All zero unless stats were enabled on the model (see
+    /// [`Model::set_stats_enabled`]) when the parser was created. Conversion
+    /// into owned [`Sentence`](crate::Sentence)s is counted under
+    /// [`ParseStats::build`] only when iterating with [`Iterator::next`].
+    #[must_use]
+    pub fn stats(&self) -> ParseStats {
+        // SAFETY: `self.inner` is a valid parser (or null).
+        ParseStats::from_ffi(unsafe { ffi::udpipe_parser_get_stats(self.inner) })
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_parse_stats_from_ffi() {
+        let stats = ParseStats::from_ffi(ffi::UdpipeStats {
+            tokenize_ns: 1,
+            tag_ns: 20,
+            parse_ns: 300,
+            build_ns: 4000,
+            sentences: 2,
+            words: 7,
+            bytes: 31,
+        });
+        assert_eq!(stats.tag, Duration::from_nanos(20));
+        assert_eq!(stats.total(), Duration::from_nanos(4321));
+        assert_eq!((stats.sentences, stats.words, stats.bytes), (2, 7, 31));
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_stats_with_null_model() {
+        let model = Model {
+            inner: std::ptr::null_mut(),
+        };
+        model.set_stats_enabled(true);
+        assert!(!model.stats_enabled());
+        model.reset_stats();
+        assert_eq!(model.stats(), ParseStats::default());
+    }
+}
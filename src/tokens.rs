@@ -0,0 +1,126 @@
+//! Tagging and parsing of text that is already split into sentences and
+//! tokens, bypassing `UDPipe`'s tokenizer.
+
+use crate::{
+    Model, ParseOptions, RawSentence, Sentence, UdpipeError, UdpipeErrorKind, ffi, ffi_try,
+};
+
+impl Model {
+    /// Tag and parse sentences that are already tokenized.
+    ///
+    /// Each element of `sentences` is one sentence given as its word forms.
+    /// The tokenizer never runs: use this when sentence splitting and
+    /// tokenization come from an upstream system. Word forms may contain any
+    /// characters, including whitespace and null bytes. Returns one
+    /// [`Sentence`] per input sentence.
+    ///
+    /// To keep `UDPipe`'s tokenizer but skip its sentence segmenter, use
+    /// [`ParseOptions::presegmented`] instead.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if tagging or parsing any sentence fails.
+    ///
+    /// # Example
+    /// ```no_run
+    /// use udpipe_rs::Model;
+    ///
+    /// let model = Model::load("english-ewt-ud-2.5-191206.udpipe").expect("Failed to load");
+    /// let sentences = model
+    ///     .parse_tokens(&[&["Hello", "world", "!"][..], &["Bye", "."][..]])
+    ///     .expect("Failed to parse");
+    /// for word in &sentences[0].words {
+    ///     println!("{} {} {}", word.form, word.upostag, word.head);
+    /// }
+    /// ```
+    pub fn parse_tokens<T, S>(&self, sentences: &[T]) -> Result<Vec<Sentence>, UdpipeError>
+    where
+        T: AsRef<[S]>,
+        S: AsRef<str>,
+    {
+        self.parse_tokens_with_options(sentences, ParseOptions::default())
+    }
+
+    /// Tag and parse already tokenized sentences with explicit
+    /// [`ParseOptions`].
+    ///
+    /// See [`Model::parse_tokens`]. Only [`ParseOptions::stages`] and
+    /// [`ParseOptions::fields`] apply; there is no tokenizer to configure.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if tagging or parsing any sentence fails.
+    pub fn parse_tokens_with_options<T, S>(
+        &self,
+        sentences: &[T],
+        options: ParseOptions,
+    ) -> Result<Vec<Sentence>, UdpipeError>
+    where
+        T: AsRef<[S]>,
+        S: AsRef<str>,
+    {
+        let options = options.to_ffi();
+        let stats = self.stats_enabled();
+        let mut forms = Vec::new();
+        let mut result = Vec::with_capacity(sentences.len());
+        for tokens in sentences {
+            forms.clear();
+            forms.extend(tokens.as_ref().iter().map(|token| {
+                let token = token.as_ref();
+                ffi::UdpipeStr {
+                    data: token.as_ptr().cast(),
+                    len: token.len(),
+                }
+            }));
+
+            let mut out_error: *const std::os::raw::c_char = std::ptr::null();
+            let raw = ffi_try(
+                &mut out_error,
+                |e| {
+                    // SAFETY: `self.inner` is a valid model; `forms` holds `forms.len()`
+                    // entries pointing into strings borrowed from `sentences`, which the C++
+                    // side copies; `options` outlives the call; `e` is a valid out-error
+                    // pointer.
+                    unsafe {
+                        ffi::udpipe_raw_sentence_new(
+                            self.inner,
+                            forms.as_ptr(),
+                            forms.len(),
+                            &raw const options,
+                            e,
+                        )
+                    }
+                },
+                UdpipeErrorKind::ParseError,
+            )?;
+            result.push(RawSentence { inner: raw, stats }.process(self)?);
+        }
+        Ok(result)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_parse_tokens_empty() {
+        let model = Model {
+            inner: std::ptr::null_mut(),
+        };
+        let sentences: [&[&str]; 0] = [];
+        assert!(model.parse_tokens(&sentences).unwrap().is_empty());
+    }
+
+    #[test]
+    #[cfg_attr(miri, ignore)]
+    fn test_parse_tokens_with_null_model() {
+        let model = Model {
+            inner: std::ptr::null_mut(),
+        };
+        let err = model.parse_tokens(&[["Hello", "world"]]).unwrap_err();
+        assert_eq!(err.kind, UdpipeErrorKind::ParseError);
+        assert!(err.message.contains("Invalid arguments"));
+    }
+}
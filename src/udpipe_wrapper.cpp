@@ -4,6 +4,9 @@
 #include "sentence/sentence.h"
 #include "utils/string_piece.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
@@ -15,10 +18,23 @@
 #include <utility>
 #include <vector>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define UDPIPE_HAVE_MMAP 1
+#endif
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
 using ufal::udpipe::input_format;
 using ufal::udpipe::model;
 using ufal::udpipe::sentence;
 using ufal::udpipe::string_piece;
+using ufal::udpipe::token;
 
 namespace {
 // Thread-local error message. *out_error points into this; valid until next API
@@ -37,89 +53,552 @@ public:
     setg(base, base, base + len);
   }
 };
+
+#ifdef UDPIPE_HAVE_MMAP
+// Read-only private mapping of a whole file, unmapped on destruction.
+class file_mapping {
+public:
+  explicit file_mapping(const char *path) {
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return;
+    }
+    struct stat st = {};
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+      size_ = static_cast<std::size_t>(st.st_size);
+      void *addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED) {
+        data_ = addr;
+        // The model is read front to back exactly once.
+        ::madvise(data_, size_, MADV_SEQUENTIAL);
+      }
+    }
+    ::close(fd);
+  }
+  ~file_mapping() {
+    if (data_ != nullptr) {
+      ::munmap(data_, size_);
+    }
+  }
+  file_mapping(const file_mapping &) = delete;
+  auto operator=(const file_mapping &) -> file_mapping & = delete;
+
+  auto data() const -> const char * { return static_cast<const char *>(data_); }
+  auto size() const -> std::size_t { return size_; }
+
+private:
+  void *data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+// std::streambuf over a file_mapping that exposes one window of the file at a
+// time and drops the pages of each window once it has been read. Touched pages
+// of a mapping count towards the process RSS, so without this the whole file
+// would stay resident next to the model being built from it.
+class mapping_streambuf : public std::streambuf {
+public:
+  // As in memory_streambuf, the get area is only read from.
+  explicit mapping_streambuf(const file_mapping &mapping)
+      : end_(const_cast<char *>(mapping.data()) + mapping.size()) {
+    char *base = const_cast<char *>(mapping.data());
+    setg(base, base, base);
+  }
+
+protected:
+  auto underflow() -> int_type override {
+    if (gptr() < egptr()) {
+      return traits_type::to_int_type(*gptr());
+    }
+    // Windows start at multiples of window_size from the page-aligned start
+    // of the mapping, as madvise requires.
+    if (egptr() != eback()) {
+      ::madvise(eback(), static_cast<std::size_t>(egptr() - eback()),
+                MADV_DONTNEED);
+    }
+    char *next = egptr();
+    if (next == end_) {
+      return traits_type::eof();
+    }
+    std::ptrdiff_t left = end_ - next;
+    setg(next, next, next + (left < window_size ? left : window_size));
+    return traits_type::to_int_type(*next);
+  }
+
+private:
+  static constexpr std::ptrdiff_t window_size = std::ptrdiff_t{1} << 20;
+  char *end_;
+};
+#endif
+} // namespace
+
+namespace {
+// One shard of the model-wide totals of UdpipeStats. The padding keeps any two
+// shards off a shared cache line whatever the alignment of the model, since
+// C++11 `new` does not honour over-aligned types.
+struct atomic_stats {
+  std::atomic<uint64_t> tokenize_ns{0};
+  std::atomic<uint64_t> tag_ns{0};
+  std::atomic<uint64_t> parse_ns{0};
+  std::atomic<uint64_t> build_ns{0};
+  std::atomic<uint64_t> sentences{0};
+  std::atomic<uint64_t> words{0};
+  std::atomic<uint64_t> bytes{0};
+  char padding[64];
+};
+
+// Concurrent parsers update the totals once per stage of every sentence, so a
+// single set of counters would bounce one cache line between all threads.
+// Each thread instead adds to its own shard, picked round-robin on the
+// thread's first update; readers sum the shards.
+constexpr size_t stats_shards = 16;
+
+auto stats_shard() -> size_t {
+  static std::atomic<size_t> next_shard{0};
+  static thread_local const size_t shard =
+      next_shard.fetch_add(1, std::memory_order_relaxed) % stats_shards;
+  return shard;
+}
 } // namespace
 
 struct UdpipeModel {
   std::unique_ptr<model> m;
+  std::atomic<bool> stats_enabled{false};
+  atomic_stats stats[stats_shards];
+};
+
+namespace {
+// (offset, len) of a NUL-terminated string stored in UdpipeSentence::arena.
+// Offsets rather than pointers so the arena may grow while being filled. The
+// zero span is the empty string at the start of the arena.
+struct arena_span {
+  size_t offset;
+  size_t len;
+};
+
+struct word_entry {
+  arena_span form;
+  arena_span lemma;
+  arena_span upostag;
+  arena_span xpostag;
+  arena_span feats;
+  arena_span deprel;
+  arena_span deps;
+  arena_span misc;
+  int32_t id;
+  int32_t head;
+  int32_t children_offset;
+  int32_t children_count;
+  size_t start;
+  size_t end;
+};
+
+// Byte range of a token in the parser's text.
+struct byte_range {
+  size_t start;
+  size_t end;
+};
+
+// Maps the character offsets of UDPipe's TokenRange, which count Unicode
+// characters from the start of the document, to byte offsets in the text
+// currently being tokenized. Lookups mostly move forward, so each resumes
+// where the previous one stopped.
+class offset_map {
+public:
+  // Continue the document with `text`. The previous text must have been
+  // released with finish_text; it is not read again.
+  void set_text(const char *text, size_t len) {
+    text_ = text;
+    len_ = len;
+    text_chars_ = char_pos_;
+    byte_pos_ = 0;
+  }
+
+  auto byte_offset(size_t char_offset) -> size_t {
+    if (char_offset < char_pos_) {
+      char_pos_ = text_chars_;
+      byte_pos_ = 0;
+    }
+    while (char_pos_ < char_offset && byte_pos_ < len_) {
+      advance();
+    }
+    return byte_pos_;
+  }
+
+  // Count the characters left in the current text and stop reading it, so
+  // that the caller may free or overwrite it before the next set_text.
+  void finish_text() {
+    while (byte_pos_ < len_) {
+      advance();
+    }
+    text_ = nullptr;
+    len_ = 0;
+    byte_pos_ = 0;
+  }
+
+private:
+  // Step over one UTF-8 character.
+  void advance() {
+    byte_pos_++;
+    while (byte_pos_ < len_ &&
+           (static_cast<unsigned char>(text_[byte_pos_]) & 0xC0U) == 0x80U) {
+      byte_pos_++;
+    }
+    char_pos_++;
+  }
+
+  const char *text_ = nullptr;
+  size_t len_ = 0;
+  // Characters in the document before text_.
+  size_t text_chars_ = 0;
+  size_t char_pos_ = 0;
+  size_t byte_pos_ = 0;
+};
+
+struct multiword_token_entry {
+  arena_span form;
+  arena_span misc;
+  int32_t id_first;
+  int32_t id_last;
+};
+} // namespace
+
+// Single sentence with all data from UDPipe. Every string lives in one byte
+// arena; clear() keeps the capacity of all buffers so a sentence reused across
+// udpipe_parser_next calls stops allocating once it has seen its largest input.
+struct UdpipeSentence {
+  std::string arena;
+  std::vector<word_entry> words;
+  std::vector<int32_t> children;
+  std::vector<multiword_token_entry> multiword_tokens;
+  std::vector<arena_span> comments;
+
+  void clear() {
+    arena.assign(1, '\0');
+    words.clear();
+    children.clear();
+    multiword_tokens.clear();
+    comments.clear();
+  }
+
+  auto append(const std::string &value) -> arena_span {
+    arena_span const result = {arena.size(), value.size()};
+    arena.append(value);
+    arena.push_back('\0');
+    return result;
+  }
+
+  auto c_str(arena_span value) const -> const char * {
+    return arena.data() + value.offset;
+  }
+
+  auto view(arena_span value) const -> UdpipeStr {
+    return UdpipeStr{arena.data() + value.offset, value.len};
+  }
+};
+
+// Tokenized sentence detached from its parser, so that tagging and parsing can
+// run on another thread. `result` is filled by udpipe_raw_sentence_result.
+// `model`, `stages`, `fields` and `stats_enabled` are inherited from the parser
+// that tokenized it.
+struct UdpipeRawSentence {
+  sentence tokens;
+  // Byte range of each word of `tokens`; empty without UDPIPE_TOKENIZER_RANGES.
+  std::vector<byte_range> ranges;
+  UdpipeSentence result;
+  UdpipeModel *model = nullptr;
+  int32_t stages = UDPIPE_STAGE_PARSE;
+  uint32_t fields = UDPIPE_FIELD_ALL;
+  bool stats_enabled = false;
 };
 
 // Streaming parser that yields one sentence at a time
 struct UdpipeParser {
   UdpipeModel *model = nullptr;
   std::unique_ptr<input_format> tokenizer;
+  // The sentence being processed by udpipe_parser_next and its result; both
+  // are reused across calls.
+  sentence tokens;
+  UdpipeSentence result;
   bool finished = false;
   bool errored = false;
+  int32_t stages = UDPIPE_STAGE_PARSE;
+  uint32_t fields = UDPIPE_FIELD_ALL;
+  // Set with UDPIPE_TOKENIZER_RANGES: word byte ranges are computed into
+  // `ranges` using `offsets`.
+  bool ranges_enabled = false;
+  offset_map offsets;
+  std::vector<byte_range> ranges;
+  // Sampled from the model when the parser is created.
+  bool stats_enabled = false;
+  UdpipeStats stats = {};
 };
 
-// Single sentence with all data from UDPipe
-struct UdpipeSentence {
-  std::vector<std::string> forms;
-  std::vector<std::string> lemmas;
-  std::vector<std::string> upostags;
-  std::vector<std::string> xpostags;
-  std::vector<std::string> feats;
-  std::vector<std::string> deprels;
-  std::vector<std::string> deps;
-  std::vector<std::string> miscs;
-  std::vector<int32_t> ids;
-  std::vector<int32_t> heads;
-  std::vector<int32_t> children_flat;
-  std::vector<int32_t> children_offsets;
-  std::vector<int32_t> children_counts;
-  std::vector<std::string> mwt_forms;
-  std::vector<std::string> mwt_miscs;
-  std::vector<int32_t> mwt_id_firsts;
-  std::vector<int32_t> mwt_id_lasts;
-  std::vector<std::string> comments;
-};
+namespace {
+using stats_clock = std::chrono::steady_clock;
+
+// Start of a timed stage; the epoch when stats are disabled, so that disabled
+// stats cost no clock reads.
+auto stage_start(bool enabled) -> stats_clock::time_point {
+  return enabled ? stats_clock::now() : stats_clock::time_point();
+}
+
+auto stage_ns(bool enabled, stats_clock::time_point start) -> uint64_t {
+  if (!enabled) {
+    return 0;
+  }
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(stats_clock::now() -
+                                                           start)
+          .count());
+}
+
+// Add `delta` to the model totals and, if given, to a parser's own stats.
+void record_stats(UdpipeModel *model, UdpipeStats *local,
+                  const UdpipeStats &delta) {
+  if (local != nullptr) {
+    local->tokenize_ns += delta.tokenize_ns;
+    local->tag_ns += delta.tag_ns;
+    local->parse_ns += delta.parse_ns;
+    local->build_ns += delta.build_ns;
+    local->sentences += delta.sentences;
+    local->words += delta.words;
+    local->bytes += delta.bytes;
+  }
+  if (model == nullptr) {
+    return;
+  }
+  atomic_stats &totals = model->stats[stats_shard()];
+  totals.tokenize_ns.fetch_add(delta.tokenize_ns, std::memory_order_relaxed);
+  totals.tag_ns.fetch_add(delta.tag_ns, std::memory_order_relaxed);
+  totals.parse_ns.fetch_add(delta.parse_ns, std::memory_order_relaxed);
+  totals.build_ns.fetch_add(delta.build_ns, std::memory_order_relaxed);
+  totals.sentences.fetch_add(delta.sentences, std::memory_order_relaxed);
+  totals.words.fetch_add(delta.words, std::memory_order_relaxed);
+  totals.bytes.fetch_add(delta.bytes, std::memory_order_relaxed);
+}
+
+// UDPipe tokenizer option string for a UDPIPE_TOKENIZER_* mask.
+auto tokenizer_options(uint32_t flags) -> std::string {
+  std::string result = model::DEFAULT;
+  if ((flags & UDPIPE_TOKENIZER_PRESEGMENTED) != 0) {
+    result += result.empty() ? "" : ";";
+    result += model::TOKENIZER_PRESEGMENTED;
+  }
+  if ((flags & UDPIPE_TOKENIZER_RANGES) != 0) {
+    result += result.empty() ? "" : ";";
+    result += model::TOKENIZER_RANGES;
+  }
+  return result;
+}
+
+// Number of words of a tokenized sentence, excluding the virtual root.
+auto word_count(const sentence &tokens) -> uint64_t {
+  return tokens.words.empty() ? 0 : tokens.words.size() - 1;
+}
+} // namespace
 
 namespace {
-auto build_sentence(const sentence &current_sentence) -> UdpipeSentence * {
-  auto *result = new UdpipeSentence();
+// Copy the UDPIPE_FIELD_* columns selected by `fields` from `current_sentence`
+// into `result`; unselected strings are left as the empty zero span. `ranges`
+// holds the byte range of each word, or is empty.
+void build_sentence(const sentence &current_sentence, UdpipeSentence &result,
+                    uint32_t fields, const std::vector<byte_range> &ranges) {
+  result.clear();
   size_t const word_count =
       !current_sentence.words.empty() ? current_sentence.words.size() - 1 : 0;
-  result->forms.reserve(word_count);
-  result->lemmas.reserve(word_count);
-  result->upostags.reserve(word_count);
-  result->xpostags.reserve(word_count);
-  result->feats.reserve(word_count);
-  result->deprels.reserve(word_count);
-  result->deps.reserve(word_count);
-  result->miscs.reserve(word_count);
-  result->ids.reserve(word_count);
-  result->heads.reserve(word_count);
-  result->children_offsets.reserve(word_count);
-  result->children_counts.reserve(word_count);
+  result.words.reserve(word_count);
 
   for (size_t idx = 1; idx < current_sentence.words.size(); idx++) {
     const auto &word = current_sentence.words[idx];
-    result->forms.push_back(word.form);
-    result->lemmas.push_back(word.lemma);
-    result->upostags.push_back(word.upostag);
-    result->xpostags.push_back(word.xpostag);
-    result->feats.push_back(word.feats);
-    result->deprels.push_back(word.deprel);
-    result->deps.push_back(word.deps);
-    result->miscs.push_back(word.misc);
-    result->ids.push_back(static_cast<int32_t>(word.id));
-    result->heads.push_back(word.head);
-    result->children_offsets.push_back(
-        static_cast<int32_t>(result->children_flat.size()));
-    result->children_counts.push_back(
-        static_cast<int32_t>(word.children.size()));
-    for (int child_id : word.children) {
-      result->children_flat.push_back(static_cast<int32_t>(child_id));
-    }
-  }
-
-  for (const auto &mwt : current_sentence.multiword_tokens) {
-    result->mwt_forms.push_back(mwt.form);
-    result->mwt_miscs.push_back(mwt.misc);
-    result->mwt_id_firsts.push_back(static_cast<int32_t>(mwt.id_first));
-    result->mwt_id_lasts.push_back(static_cast<int32_t>(mwt.id_last));
-  }
-  result->comments = current_sentence.comments;
-  return result;
+    word_entry entry = {};
+    if ((fields & UDPIPE_FIELD_FORM) != 0) {
+      entry.form = result.append(word.form);
+    }
+    if ((fields & UDPIPE_FIELD_LEMMA) != 0) {
+      entry.lemma = result.append(word.lemma);
+    }
+    if ((fields & UDPIPE_FIELD_UPOSTAG) != 0) {
+      entry.upostag = result.append(word.upostag);
+    }
+    if ((fields & UDPIPE_FIELD_XPOSTAG) != 0) {
+      entry.xpostag = result.append(word.xpostag);
+    }
+    if ((fields & UDPIPE_FIELD_FEATS) != 0) {
+      entry.feats = result.append(word.feats);
+    }
+    if ((fields & UDPIPE_FIELD_DEPREL) != 0) {
+      entry.deprel = result.append(word.deprel);
+    }
+    if ((fields & UDPIPE_FIELD_DEPS) != 0) {
+      entry.deps = result.append(word.deps);
+    }
+    if ((fields & UDPIPE_FIELD_MISC) != 0) {
+      entry.misc = result.append(word.misc);
+    }
+    entry.id = static_cast<int32_t>(word.id);
+    entry.head = word.head;
+    entry.children_offset = static_cast<int32_t>(result.children.size());
+    if ((fields & UDPIPE_FIELD_CHILDREN) != 0) {
+      entry.children_count = static_cast<int32_t>(word.children.size());
+      for (int child_id : word.children) {
+        result.children.push_back(static_cast<int32_t>(child_id));
+      }
+    }
+    if (idx < ranges.size()) {
+      entry.start = ranges[idx].start;
+      entry.end = ranges[idx].end;
+    }
+    result.words.push_back(entry);
+  }
+
+  if ((fields & UDPIPE_FIELD_MULTIWORD_TOKENS) != 0) {
+    for (const auto &mwt : current_sentence.multiword_tokens) {
+      multiword_token_entry entry = {};
+      entry.form = result.append(mwt.form);
+      entry.misc = result.append(mwt.misc);
+      entry.id_first = static_cast<int32_t>(mwt.id_first);
+      entry.id_last = static_cast<int32_t>(mwt.id_last);
+      result.multiword_tokens.push_back(entry);
+    }
+  }
+  if ((fields & UDPIPE_FIELD_COMMENTS) != 0) {
+    for (const auto &comment : current_sentence.comments) {
+      result.comments.push_back(result.append(comment));
+    }
+  }
+}
+
+auto find_word(UdpipeSentence *sentence, int32_t index) -> const word_entry * {
+  if (sentence == nullptr || index < 0 ||
+      static_cast<size_t>(index) >= sentence->words.size()) {
+    return nullptr;
+  }
+  return &sentence->words[static_cast<size_t>(index)];
+}
+
+auto find_multiword_token(UdpipeSentence *sentence, int32_t index)
+    -> const multiword_token_entry * {
+  if (sentence == nullptr || index < 0 ||
+      static_cast<size_t>(index) >= sentence->multiword_tokens.size()) {
+    return nullptr;
+  }
+  return &sentence->multiword_tokens[static_cast<size_t>(index)];
+}
+
+auto find_comment(UdpipeSentence *sentence, int32_t index)
+    -> const arena_span * {
+  if (sentence == nullptr || index < 0 ||
+      static_cast<size_t>(index) >= sentence->comments.size()) {
+    return nullptr;
+  }
+  return &sentence->comments[static_cast<size_t>(index)];
+}
+
+// Store `message` as this thread's last error and point *out_error at it.
+void report_error(const std::string &message, const char **out_error) {
+  last_error() = message;
+  if (out_error != nullptr) {
+    *out_error = last_error().c_str();
+  }
+}
+
+// Store the byte range of `tok` in the parser's text into `range`; returns
+// false if the tokenizer recorded none.
+auto token_byte_range(UdpipeParser *parser, const token &tok,
+                      byte_range &range) -> bool {
+  size_t start = 0;
+  size_t end = 0;
+  if (!tok.get_token_range(start, end)) {
+    return false;
+  }
+  range.start = parser->offsets.byte_offset(start);
+  range.end = parser->offsets.byte_offset(end);
+  return true;
+}
+
+// Fill `ranges` with the byte range of each word of `tokens`, in text order.
+// Words of a multiword token share the range of that token.
+void word_byte_ranges(UdpipeParser *parser, const sentence &tokens,
+                      std::vector<byte_range> &ranges) {
+  ranges.assign(tokens.words.size(), byte_range{0, 0});
+  size_t next_mwt = 0;
+  for (size_t idx = 1; idx < tokens.words.size(); idx++) {
+    byte_range range = {0, 0};
+    if (next_mwt < tokens.multiword_tokens.size() &&
+        static_cast<size_t>(tokens.multiword_tokens[next_mwt].id_first) ==
+            idx) {
+      const auto &mwt = tokens.multiword_tokens[next_mwt++];
+      if (token_byte_range(parser, mwt, range)) {
+        const size_t last = std::min(static_cast<size_t>(mwt.id_last),
+                                     tokens.words.size() - 1);
+        for (size_t word = idx; word <= last; word++) {
+          ranges[word] = range;
+        }
+        idx = std::max(idx, last);
+        continue;
+      }
+    }
+    if (token_byte_range(parser, tokens.words[idx], range)) {
+      ranges[idx] = range;
+    }
+  }
+}
+
+// Tokenize the next sentence of `parser` into `tokens`, and the byte ranges of
+// its words into `ranges` if enabled. At end of text or on a tokenizer error,
+// marks the parser finished (and errored), sets *out_error (nullptr at end of
+// text) and returns false.
+auto tokenize_next(UdpipeParser *parser, sentence &tokens,
+                   std::vector<byte_range> &ranges, const char **out_error)
+    -> bool {
+  std::string error;
+  if (parser->tokenizer->next_sentence(tokens, error)) {
+    if (parser->ranges_enabled) {
+      word_byte_ranges(parser, tokens, ranges);
+    }
+    return true;
+  }
+  parser->finished = true;
+  if (parser->ranges_enabled) {
+    // The caller may reuse the text's buffer once the parser has finished.
+    parser->offsets.finish_text();
+  }
+  if (!error.empty()) {
+    parser->errored = true;
+    report_error(error, out_error);
+  } else if (out_error != nullptr) {
+    *out_error = nullptr;
+  }
+  return false;
+}
+
+auto tag_sentence(const model &tagger, sentence &tokens,
+                  const char **out_error) -> bool {
+  std::string error;
+  tagger.tag(tokens, model::DEFAULT, error);
+  if (!error.empty()) {
+    report_error(error, out_error);
+    return false;
+  }
+  return true;
+}
+
+auto parse_sentence(const model &dependency_parser, sentence &tokens,
+                    const char **out_error) -> bool {
+  std::string error;
+  dependency_parser.parse(tokens, model::DEFAULT, error);
+  if (!error.empty()) {
+    report_error(error, out_error);
+    return false;
+  }
+  return true;
+}
+
+auto children_of(UdpipeSentence *sentence, const word_entry &entry)
+    -> const int32_t * {
+  return entry.children_count > 0
+             ? &sentence->children[static_cast<size_t>(entry.children_offset)]
+             : nullptr;
 }
 } // namespace
 
@@ -163,10 +642,129 @@ auto udpipe_model_load_from_memory(const uint8_t *data, size_t len,
   return wrapper;
 }
 
+auto udpipe_model_load_mmap(const char *model_path, const char **out_error)
+    -> UdpipeModel * {
+#ifdef UDPIPE_HAVE_MMAP
+  last_error().clear();
+
+  if (model_path == nullptr) {
+    report_error("Invalid arguments to udpipe_model_load_mmap", out_error);
+    return nullptr;
+  }
+
+  file_mapping mapping(model_path);
+  if (mapping.data() == nullptr) {
+    report_error(std::string("Failed to map model file: ") + model_path,
+                 out_error);
+    return nullptr;
+  }
+
+  mapping_streambuf buf(mapping);
+  std::istream model_stream(&buf);
+
+  std::unique_ptr<model> loaded_model(model::load(model_stream));
+  if (!loaded_model) {
+    report_error(std::string("Failed to load model from: ") + model_path,
+                 out_error);
+    return nullptr;
+  }
+
+  auto *wrapper = new UdpipeModel();
+  wrapper->m = std::move(loaded_model);
+  return wrapper;
+#else
+  return udpipe_model_load(model_path, out_error);
+#endif
+}
+
 void udpipe_model_free(UdpipeModel *model) { delete model; }
 
+auto udpipe_thread_set_cpus(const size_t *cpus, size_t len) -> bool {
+#ifdef __linux__
+  if (cpus == nullptr || len == 0) {
+    return false;
+  }
+  const size_t count = *std::max_element(cpus, cpus + len) + 1;
+  cpu_set_t *set = CPU_ALLOC(count);
+  if (set == nullptr) {
+    return false;
+  }
+  const size_t size = CPU_ALLOC_SIZE(count);
+  CPU_ZERO_S(size, set);
+  for (size_t i = 0; i < len; ++i) {
+    CPU_SET_S(cpus[i], size, set);
+  }
+  const bool ok = sched_setaffinity(0, size, set) == 0;
+  CPU_FREE(set);
+  return ok;
+#else
+  (void)cpus;
+  (void)len;
+  return false;
+#endif
+}
+
+auto udpipe_thread_current_cpu() -> int32_t {
+#ifdef __linux__
+  return static_cast<int32_t>(sched_getcpu());
+#else
+  return -1;
+#endif
+}
+
+void udpipe_model_set_stats_enabled(UdpipeModel *model, bool enabled) {
+  if (model != nullptr) {
+    model->stats_enabled.store(enabled, std::memory_order_relaxed);
+  }
+}
+
+auto udpipe_model_stats_enabled(UdpipeModel *model) -> bool {
+  return model != nullptr &&
+         model->stats_enabled.load(std::memory_order_relaxed);
+}
+
+auto udpipe_model_get_stats(UdpipeModel *model) -> UdpipeStats {
+  UdpipeStats stats = {};
+  if (model == nullptr) {
+    return stats;
+  }
+  for (const atomic_stats &shard : model->stats) {
+    stats.tokenize_ns += shard.tokenize_ns.load(std::memory_order_relaxed);
+    stats.tag_ns += shard.tag_ns.load(std::memory_order_relaxed);
+    stats.parse_ns += shard.parse_ns.load(std::memory_order_relaxed);
+    stats.build_ns += shard.build_ns.load(std::memory_order_relaxed);
+    stats.sentences += shard.sentences.load(std::memory_order_relaxed);
+    stats.words += shard.words.load(std::memory_order_relaxed);
+    stats.bytes += shard.bytes.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+void udpipe_model_reset_stats(UdpipeModel *model) {
+  if (model == nullptr) {
+    return;
+  }
+  for (atomic_stats &shard : model->stats) {
+    shard.tokenize_ns.store(0, std::memory_order_relaxed);
+    shard.tag_ns.store(0, std::memory_order_relaxed);
+    shard.parse_ns.store(0, std::memory_order_relaxed);
+    shard.build_ns.store(0, std::memory_order_relaxed);
+    shard.sentences.store(0, std::memory_order_relaxed);
+    shard.words.store(0, std::memory_order_relaxed);
+    shard.bytes.store(0, std::memory_order_relaxed);
+  }
+}
+
 auto udpipe_parser_new(UdpipeModel *model, const char *text, size_t text_len,
                        const char **out_error) -> UdpipeParser * {
+  return udpipe_parser_new_with_options(model, text, text_len, nullptr,
+                                        out_error);
+}
+
+auto udpipe_parser_new_with_options(UdpipeModel *model, const char *text,
+                                    size_t text_len,
+                                    const UdpipeParseOptions *options,
+                                    const char **out_error) -> UdpipeParser * {
   if (model == nullptr || !model->m || text == nullptr) {
     last_error() = "Invalid arguments to udpipe_parser_new";
     if (out_error != nullptr) {
@@ -177,8 +775,9 @@ auto udpipe_parser_new(UdpipeModel *model, const char *text, size_t text_len,
 
   last_error().clear();
 
+  const uint32_t tokenizer_flags = options != nullptr ? options->tokenizer : 0;
   std::unique_ptr<input_format> tokenizer(
-      model->m->new_tokenizer(model::DEFAULT));
+      model->m->new_tokenizer(tokenizer_options(tokenizer_flags)));
   if (!tokenizer) {
     last_error() = "Failed to create tokenizer";
     if (out_error != nullptr) {
@@ -189,12 +788,27 @@ auto udpipe_parser_new(UdpipeModel *model, const char *text, size_t text_len,
 
   // Set text to tokenize with explicit length so we never read past initialized
   // bytes (avoids MSan use-of-uninitialized-value from strlen/string_piece).
-  tokenizer->set_text(string_piece(text, text_len), true);
+  // The text is not copied; the caller keeps it alive (see header).
+  tokenizer->set_text(string_piece(text, text_len), false);
 
   auto *parser = new UdpipeParser();
   parser->model = model;
   parser->tokenizer = std::move(tokenizer);
   parser->finished = false;
+  parser->stages = options != nullptr ? options->stages : UDPIPE_STAGE_PARSE;
+  parser->fields = options != nullptr
+                       ? options->fields
+                       : static_cast<uint32_t>(UDPIPE_FIELD_ALL);
+  parser->ranges_enabled = (tokenizer_flags & UDPIPE_TOKENIZER_RANGES) != 0;
+  if (parser->ranges_enabled) {
+    parser->offsets.set_text(text, text_len);
+  }
+  parser->stats_enabled = model->stats_enabled.load(std::memory_order_relaxed);
+  if (parser->stats_enabled) {
+    UdpipeStats delta = {};
+    delta.bytes = text_len;
+    record_stats(model, &parser->stats, delta);
+  }
 
   return parser;
 }
@@ -208,48 +822,114 @@ auto udpipe_parser_next(UdpipeParser *parser, const char **out_error)
     return nullptr;
   }
 
-  sentence current_sentence;
-  std::string error;
+  const bool timed = parser->stats_enabled;
+  UdpipeStats delta = {};
 
-  if (!parser->tokenizer->next_sentence(current_sentence, error)) {
-    parser->finished = true;
-    if (!error.empty()) {
-      last_error() = error;
-      parser->errored = true;
-      if (out_error != nullptr) {
-        *out_error = last_error().c_str();
-      }
-    } else {
-      if (out_error != nullptr) {
-        *out_error = nullptr;
-      }
+  // Reuse the parser's sentence: the tokenizer clears it but its buffers keep
+  // their capacity.
+  sentence &current_sentence = parser->tokens;
+  auto start = stage_start(timed);
+  const bool tokenized =
+      tokenize_next(parser, current_sentence, parser->ranges, out_error);
+  delta.tokenize_ns = stage_ns(timed, start);
+  if (!tokenized) {
+    if (timed) {
+      record_stats(parser->model, &parser->stats, delta);
     }
     return nullptr;
   }
 
-  parser->model->m->tag(current_sentence, model::DEFAULT, error);
-  if (!error.empty()) {
-    last_error() = error;
+  const model &loaded = *parser->model->m;
+  bool ok = true;
+  if (parser->stages >= UDPIPE_STAGE_TAG) {
+    start = stage_start(timed);
+    ok = tag_sentence(loaded, current_sentence, out_error);
+    delta.tag_ns = stage_ns(timed, start);
+  }
+  if (ok && parser->stages >= UDPIPE_STAGE_PARSE) {
+    start = stage_start(timed);
+    ok = parse_sentence(loaded, current_sentence, out_error);
+    delta.parse_ns = stage_ns(timed, start);
+  }
+  if (!ok) {
+    if (timed) {
+      record_stats(parser->model, &parser->stats, delta);
+    }
     parser->finished = true;
     parser->errored = true;
-    if (out_error != nullptr) {
-      *out_error = last_error().c_str();
-    }
     return nullptr;
   }
 
-  parser->model->m->parse(current_sentence, model::DEFAULT, error);
-  if (!error.empty()) {
-    last_error() = error;
-    parser->finished = true;
-    parser->errored = true;
-    if (out_error != nullptr) {
-      *out_error = last_error().c_str();
-    }
-    return nullptr;
+  start = stage_start(timed);
+  build_sentence(current_sentence, parser->result, parser->fields,
+                 parser->ranges);
+  delta.build_ns = stage_ns(timed, start);
+  if (timed) {
+    delta.sentences = 1;
+    delta.words = word_count(current_sentence);
+    record_stats(parser->model, &parser->stats, delta);
+  }
+  return &parser->result;
+}
+
+auto udpipe_parser_set_text(UdpipeParser *parser, const char *text,
+                            size_t text_len, const char **out_error) -> bool {
+  if (parser == nullptr || text == nullptr) {
+    report_error("Invalid arguments to udpipe_parser_set_text", out_error);
+    return false;
+  }
+  if (parser->errored) {
+    report_error("Parser has already failed", out_error);
+    return false;
+  }
+
+  last_error().clear();
+  if (out_error != nullptr) {
+    *out_error = nullptr;
+  }
+
+  // The text continues the current document; no reset_document() is done, so
+  // sentence ids keep counting up.
+  parser->tokenizer->set_text(string_piece(text, text_len), false);
+  if (parser->ranges_enabled) {
+    parser->offsets.set_text(text, text_len);
+  }
+  parser->finished = false;
+  if (parser->stats_enabled) {
+    UdpipeStats delta = {};
+    delta.bytes = text_len;
+    record_stats(parser->model, &parser->stats, delta);
+  }
+  return true;
+}
+
+auto udpipe_parser_reset(UdpipeParser *parser, const char *text,
+                         size_t text_len, const char **out_error) -> bool {
+  if (parser == nullptr || text == nullptr) {
+    report_error("Invalid arguments to udpipe_parser_reset", out_error);
+    return false;
+  }
+
+  last_error().clear();
+  if (out_error != nullptr) {
+    *out_error = nullptr;
   }
 
-  return build_sentence(current_sentence);
+  // Start a new document, keeping the tokenizer and all buffers.
+  parser->tokenizer->reset_document();
+  parser->tokenizer->set_text(string_piece(text, text_len), false);
+  if (parser->ranges_enabled) {
+    parser->offsets = offset_map();
+    parser->offsets.set_text(text, text_len);
+  }
+  parser->finished = false;
+  parser->errored = false;
+  if (parser->stats_enabled) {
+    UdpipeStats delta = {};
+    delta.bytes = text_len;
+    record_stats(parser->model, &parser->stats, delta);
+  }
+  return true;
 }
 
 auto udpipe_parser_has_error(UdpipeParser *parser) -> bool {
@@ -258,41 +938,204 @@ auto udpipe_parser_has_error(UdpipeParser *parser) -> bool {
 
 void udpipe_parser_free(UdpipeParser *parser) { delete parser; }
 
-void udpipe_sentence_free(UdpipeSentence *sentence) { delete sentence; }
+auto udpipe_parser_get_stats(UdpipeParser *parser) -> UdpipeStats {
+  if (parser == nullptr) {
+    return UdpipeStats{};
+  }
+  return parser->stats;
+}
+
+void udpipe_parser_add_build_ns(UdpipeParser *parser, uint64_t ns) {
+  if (parser == nullptr || !parser->stats_enabled) {
+    return;
+  }
+  UdpipeStats delta = {};
+  delta.build_ns = ns;
+  record_stats(parser->model, &parser->stats, delta);
+}
+
+auto udpipe_parser_next_raw(UdpipeParser *parser, const char **out_error)
+    -> UdpipeRawSentence * {
+  if (parser == nullptr || parser->finished) {
+    if (out_error != nullptr) {
+      *out_error = nullptr;
+    }
+    return nullptr;
+  }
+
+  const bool timed = parser->stats_enabled;
+  UdpipeStats delta = {};
+
+  std::unique_ptr<UdpipeRawSentence> raw(new UdpipeRawSentence());
+  raw->model = parser->model;
+  raw->stages = parser->stages;
+  raw->fields = parser->fields;
+  raw->stats_enabled = timed;
+  const auto start = stage_start(timed);
+  const bool tokenized =
+      tokenize_next(parser, raw->tokens, raw->ranges, out_error);
+  delta.tokenize_ns = stage_ns(timed, start);
+  if (tokenized) {
+    delta.words = word_count(raw->tokens);
+  }
+  if (timed) {
+    record_stats(parser->model, &parser->stats, delta);
+  }
+  return tokenized ? raw.release() : nullptr;
+}
+
+auto udpipe_raw_sentence_new(UdpipeModel *model, const UdpipeStr *forms,
+                             size_t count, const UdpipeParseOptions *options,
+                             const char **out_error) -> UdpipeRawSentence * {
+  if (model == nullptr || !model->m || (forms == nullptr && count > 0)) {
+    report_error("Invalid arguments to udpipe_raw_sentence_new", out_error);
+    return nullptr;
+  }
+
+  std::unique_ptr<UdpipeRawSentence> raw(new UdpipeRawSentence());
+  raw->model = model;
+  if (options != nullptr) {
+    raw->stages = options->stages;
+    raw->fields = options->fields;
+  }
+  raw->stats_enabled = model->stats_enabled.load(std::memory_order_relaxed);
+  UdpipeStats delta = {};
+  for (size_t idx = 0; idx < count; idx++) {
+    const UdpipeStr &form = forms[idx];
+    raw->tokens.add_word(string_piece(form.data, form.len));
+    delta.bytes += form.len;
+  }
+  if (raw->stats_enabled) {
+    delta.words = count;
+    record_stats(model, nullptr, delta);
+  }
+  return raw.release();
+}
+
+auto udpipe_raw_sentence_tag(UdpipeModel *model, UdpipeRawSentence *raw,
+                             const char **out_error) -> bool {
+  if (model == nullptr || !model->m || raw == nullptr) {
+    report_error("Invalid arguments to udpipe_raw_sentence_tag", out_error);
+    return false;
+  }
+  if (raw->stages < UDPIPE_STAGE_TAG) {
+    return true;
+  }
+  const bool timed = raw->stats_enabled;
+  const auto start = stage_start(timed);
+  const bool ok = tag_sentence(*model->m, raw->tokens, out_error);
+  if (timed) {
+    UdpipeStats delta = {};
+    delta.tag_ns = stage_ns(timed, start);
+    record_stats(raw->model, nullptr, delta);
+  }
+  return ok;
+}
+
+auto udpipe_raw_sentence_parse(UdpipeModel *model, UdpipeRawSentence *raw,
+                               const char **out_error) -> bool {
+  if (model == nullptr || !model->m || raw == nullptr) {
+    report_error("Invalid arguments to udpipe_raw_sentence_parse", out_error);
+    return false;
+  }
+  if (raw->stages < UDPIPE_STAGE_PARSE) {
+    return true;
+  }
+  const bool timed = raw->stats_enabled;
+  const auto start = stage_start(timed);
+  const bool ok = parse_sentence(*model->m, raw->tokens, out_error);
+  if (timed) {
+    UdpipeStats delta = {};
+    delta.parse_ns = stage_ns(timed, start);
+    record_stats(raw->model, nullptr, delta);
+  }
+  return ok;
+}
+
+auto udpipe_raw_sentence_result(UdpipeRawSentence *raw) -> UdpipeSentence * {
+  if (raw == nullptr) {
+    return nullptr;
+  }
+  const bool timed = raw->stats_enabled;
+  const auto start = stage_start(timed);
+  build_sentence(raw->tokens, raw->result, raw->fields, raw->ranges);
+  if (timed) {
+    UdpipeStats delta = {};
+    delta.build_ns = stage_ns(timed, start);
+    delta.sentences = 1;
+    record_stats(raw->model, nullptr, delta);
+  }
+  return &raw->result;
+}
+
+void udpipe_raw_sentence_add_build_ns(UdpipeRawSentence *raw, uint64_t ns) {
+  if (raw == nullptr || !raw->stats_enabled) {
+    return;
+  }
+  UdpipeStats delta = {};
+  delta.build_ns = ns;
+  record_stats(raw->model, nullptr, delta);
+}
+
+void udpipe_raw_sentence_free(UdpipeRawSentence *raw) { delete raw; }
 
 auto udpipe_sentence_word_count(UdpipeSentence *sentence) -> int32_t {
   if (sentence == nullptr) {
     return 0;
   }
-  return static_cast<int32_t>(sentence->forms.size());
+  return static_cast<int32_t>(sentence->words.size());
 }
 
 auto udpipe_sentence_get_word(UdpipeSentence *sentence, int32_t index)
     -> UdpipeWord {
   UdpipeWord word = {}; // Zero-initialize all fields
 
-  if (sentence == nullptr || index < 0 ||
-      static_cast<size_t>(index) >= sentence->forms.size()) {
+  const word_entry *entry = find_word(sentence, index);
+  if (entry == nullptr) {
+    return word;
+  }
+
+  word.form = sentence->c_str(entry->form);
+  word.lemma = sentence->c_str(entry->lemma);
+  word.upostag = sentence->c_str(entry->upostag);
+  word.xpostag = sentence->c_str(entry->xpostag);
+  word.feats = sentence->c_str(entry->feats);
+  word.deprel = sentence->c_str(entry->deprel);
+  word.deps = sentence->c_str(entry->deps);
+  word.misc = sentence->c_str(entry->misc);
+  word.id = entry->id;
+  word.head = entry->head;
+  word.children_count = entry->children_count;
+  word.children = children_of(sentence, *entry);
+  word.start = entry->start;
+  word.end = entry->end;
+
+  return word;
+}
+
+auto udpipe_sentence_get_word_view(UdpipeSentence *sentence, int32_t index)
+    -> UdpipeWordView {
+  UdpipeWordView word = {}; // Zero-initialize all fields
+
+  const word_entry *entry = find_word(sentence, index);
+  if (entry == nullptr) {
     return word;
   }
 
-  auto idx = static_cast<size_t>(index);
-  word.form = sentence->forms[idx].c_str();
-  word.lemma = sentence->lemmas[idx].c_str();
-  word.upostag = sentence->upostags[idx].c_str();
-  word.xpostag = sentence->xpostags[idx].c_str();
-  word.feats = sentence->feats[idx].c_str();
-  word.deprel = sentence->deprels[idx].c_str();
-  word.deps = sentence->deps[idx].c_str();
-  word.misc = sentence->miscs[idx].c_str();
-  word.id = sentence->ids[idx];
-  word.head = sentence->heads[idx];
-
-  // Children pointer and count
-  int32_t const offset = sentence->children_offsets[idx];
-  word.children_count = sentence->children_counts[idx];
-  word.children =
-      word.children_count > 0 ? &sentence->children_flat[offset] : nullptr;
+  word.form = sentence->view(entry->form);
+  word.lemma = sentence->view(entry->lemma);
+  word.upostag = sentence->view(entry->upostag);
+  word.xpostag = sentence->view(entry->xpostag);
+  word.feats = sentence->view(entry->feats);
+  word.deprel = sentence->view(entry->deprel);
+  word.deps = sentence->view(entry->deps);
+  word.misc = sentence->view(entry->misc);
+  word.id = entry->id;
+  word.head = entry->head;
+  word.children_count = entry->children_count;
+  word.children = children_of(sentence, *entry);
+  word.start = entry->start;
+  word.end = entry->end;
 
   return word;
 }
@@ -302,7 +1145,7 @@ auto udpipe_sentence_multiword_token_count(UdpipeSentence *sentence)
   if (sentence == nullptr) {
     return 0;
   }
-  return static_cast<int32_t>(sentence->mwt_forms.size());
+  return static_cast<int32_t>(sentence->multiword_tokens.size());
 }
 
 auto udpipe_sentence_get_multiword_token(UdpipeSentence *sentence,
@@ -310,17 +1153,34 @@ auto udpipe_sentence_get_multiword_token(UdpipeSentence *sentence,
     -> UdpipeMultiwordToken {
   UdpipeMultiwordToken mwt = {}; // Zero-initialize all fields
 
-  if (sentence == nullptr || index < 0 ||
-      static_cast<size_t>(index) >= sentence->mwt_forms.size()) {
+  // Covered by Spanish model integration test
+  const multiword_token_entry *entry = find_multiword_token(sentence, index);
+  if (entry == nullptr) {
     return mwt;
   }
 
-  // Covered by Spanish model integration test
-  auto idx = static_cast<size_t>(index);
-  mwt.form = sentence->mwt_forms[idx].c_str();
-  mwt.misc = sentence->mwt_miscs[idx].c_str();
-  mwt.id_first = sentence->mwt_id_firsts[idx];
-  mwt.id_last = sentence->mwt_id_lasts[idx];
+  mwt.form = sentence->c_str(entry->form);
+  mwt.misc = sentence->c_str(entry->misc);
+  mwt.id_first = entry->id_first;
+  mwt.id_last = entry->id_last;
+
+  return mwt;
+}
+
+auto udpipe_sentence_get_multiword_token_view(UdpipeSentence *sentence,
+                                              int32_t index)
+    -> UdpipeMultiwordTokenView {
+  UdpipeMultiwordTokenView mwt = {}; // Zero-initialize all fields
+
+  const multiword_token_entry *entry = find_multiword_token(sentence, index);
+  if (entry == nullptr) {
+    return mwt;
+  }
+
+  mwt.form = sentence->view(entry->form);
+  mwt.misc = sentence->view(entry->misc);
+  mwt.id_first = entry->id_first;
+  mwt.id_last = entry->id_last;
 
   return mwt;
 }
@@ -334,9 +1194,18 @@ auto udpipe_sentence_comment_count(UdpipeSentence *sentence) -> int32_t {
 
 auto udpipe_sentence_get_comment(UdpipeSentence *sentence, int32_t index)
     -> const char * {
-  if (sentence == nullptr || index < 0 ||
-      static_cast<size_t>(index) >= sentence->comments.size()) {
+  const arena_span *comment = find_comment(sentence, index);
+  if (comment == nullptr) {
     return nullptr;
   }
-  return sentence->comments[static_cast<size_t>(index)].c_str();
+  return sentence->c_str(*comment);
+}
+
+auto udpipe_sentence_get_comment_view(UdpipeSentence *sentence, int32_t index)
+    -> UdpipeStr {
+  const arena_span *comment = find_comment(sentence, index);
+  if (comment == nullptr) {
+    return UdpipeStr{nullptr, 0};
+  }
+  return sentence->view(*comment);
 }
@@ -1,7 +1,8 @@
 //! Integration tests for udpipe.
 //!
 //! These tests download a fresh model each run to fully test the download +
-//! parse flow. Require the `download` feature.
+//! parse flow, unless `UDPIPE_TEST_MODEL` names a local model file to use
+//! instead (for offline runs). Require the `download` feature.
 
 #![cfg(feature = "download")]
 #![allow(
@@ -9,37 +10,33 @@
     reason = "tests use stderr for diagnostic output"
 )]
 
-use std::sync::{Mutex, OnceLock};
+use std::sync::OnceLock;
 
 const MODEL_LANGUAGE: &str = "english-ewt";
 
-/// Shared model state: temp directory, model file path, and the model wrapped
-/// in Mutex. Model is wrapped in Mutex because `UDPipe` is not thread-safe for
-/// concurrent access.
-static MODEL: OnceLock<(tempfile::TempDir, String, Mutex<udpipe_rs::Model>)> = OnceLock::new();
+/// Shared model state: temp directory, model file path, and the model. Tests
+/// run in parallel and share the model directly since `Model` is `Sync`.
+static MODEL: OnceLock<(tempfile::TempDir, String, udpipe_rs::Model)> = OnceLock::new();
 
 /// Initialize the shared model and return a reference to its state.
-fn get_model_state() -> &'static (tempfile::TempDir, String, Mutex<udpipe_rs::Model>) {
+fn get_model_state() -> &'static (tempfile::TempDir, String, udpipe_rs::Model) {
     MODEL.get_or_init(|| {
         let temp_dir = tempfile::tempdir().expect("Failed to create temp directory");
 
-        eprintln!("Downloading {MODEL_LANGUAGE} model for integration tests...");
-        let model_path = udpipe_rs::download_model(MODEL_LANGUAGE, temp_dir.path())
-            .expect("Failed to download model for integration tests");
+        let model_path = std::env::var("UDPIPE_TEST_MODEL").unwrap_or_else(|_| {
+            eprintln!("Downloading {MODEL_LANGUAGE} model for integration tests...");
+            udpipe_rs::download_model(MODEL_LANGUAGE, temp_dir.path())
+                .expect("Failed to download model for integration tests")
+        });
 
         let model = udpipe_rs::Model::load(&model_path).expect("Failed to load model");
-        (temp_dir, model_path, Mutex::new(model))
+        (temp_dir, model_path, model)
     })
 }
 
 /// Parse text with the shared model, collecting all sentences.
 fn parse_sentences(text: &str) -> Result<Vec<udpipe_rs::Sentence>, udpipe_rs::UdpipeError> {
-    get_model_state()
-        .2
-        .lock()
-        .expect("Model mutex poisoned")
-        .parser(text)?
-        .collect()
+    get_model_state().2.parser(text)?.collect()
 }
 
 /// Parse text and flatten all words from all sentences.
@@ -212,14 +209,15 @@ fn test_children_field() {
 
 #[test]
 fn test_parser_with_null_byte() {
-    // Extract error immediately - UdpipeError doesn't borrow from model
-    let err = get_model_state()
-        .2
-        .lock()
-        .expect("Model mutex poisoned")
-        .parser("Hello\0world")
-        .expect_err("parser should reject null bytes");
-    assert!(err.message.contains("null byte"));
+    // The text is passed with its length, so an embedded NUL is just another
+    // character to the tokenizer.
+    let sentences = parse_sentences("Hello\0world. Bye.").expect("Failed to parse");
+    assert!(!sentences.is_empty());
+    assert!(
+        sentences
+            .iter()
+            .any(|s| s.words.iter().any(|w| w.form == "Bye"))
+    );
 }
 
 #[test]
@@ -243,6 +241,22 @@ fn test_load_from_memory() {
     assert!(!sentences.is_empty());
 }
 
+#[test]
+fn test_load_mmap() {
+    let model_path = &get_model_state().1;
+    let model = udpipe_rs::Model::load_mmap(model_path).expect("Failed to load via mmap");
+
+    let sentences: Vec<_> = model
+        .parser("Test sentence.")
+        .expect("Failed to create parser")
+        .collect::<Result<Vec<_>, _>>()
+        .expect("Failed to parse");
+    assert_eq!(
+        sentences,
+        parse_sentences("Test sentence.").expect("Failed to parse")
+    );
+}
+
 #[test]
 fn test_model_drop() {
     // Test explicit drop to help coverage track the Drop impl
@@ -285,11 +299,8 @@ fn test_word_pos_tags() {
 
 #[test]
 fn test_streaming_iterator() {
-    // Collect sentences while holding the lock, then release it
     let sentences: Vec<_> = get_model_state()
         .2
-        .lock()
-        .expect("Model mutex poisoned")
         .parser("First sentence. Second sentence.")
         .expect("Failed to create parser")
         .collect();
@@ -307,8 +318,6 @@ fn test_iterator_early_termination() {
     // Test that we can stop iterating early - take only 2 sentences
     let sentences: Vec<_> = get_model_state()
         .2
-        .lock()
-        .expect("Model mutex poisoned")
         .parser("One. Two. Three. Four. Five.")
         .expect("Failed to create parser")
         .take(2)
@@ -369,3 +378,676 @@ fn test_multiword_tokens_spanish() {
         }
     }
 }
+
+#[test]
+fn test_next_ref_matches_owned() {
+    let text = "The cat sleeps. The dog barks.";
+    let owned = parse_sentences(text).expect("Failed to parse");
+
+    let mut parser = get_model_state()
+        .2
+        .parser(text)
+        .expect("Failed to create parser");
+    let mut borrowed = Vec::new();
+    while let Some(sentence) = parser.next_ref() {
+        let sentence = sentence.expect("Failed to parse sentence");
+        assert_eq!(sentence.words().len(), sentence.word_count());
+        for (idx, word) in sentence.words().enumerate() {
+            assert_eq!(Some(word), sentence.word(idx));
+        }
+        borrowed.push(sentence.to_sentence());
+    }
+
+    assert_eq!(owned, borrowed);
+}
+
+#[test]
+fn test_concurrent_parsing_shared_model() {
+    let model = &get_model_state().2;
+    let texts = [
+        "The cat sleeps.",
+        "The dog barks loudly.",
+        "Birds fly south in winter.",
+        "She reads a book.",
+    ];
+    let expected: Vec<_> = texts
+        .iter()
+        .map(|text| parse_sentences(text).expect("Failed to parse"))
+        .collect();
+
+    // Many threads parse through the same `&Model` at once; results must match
+    // the sequential run.
+    std::thread::scope(|s| {
+        #[allow(
+            clippy::needless_collect,
+            reason = "spawn every thread before joining any"
+        )]
+        let handles: Vec<_> = (0..16)
+            .map(|i| {
+                let text = texts[i % texts.len()];
+                s.spawn(move || {
+                    model
+                        .parser(text)
+                        .expect("Failed to create parser")
+                        .collect::<Result<Vec<_>, _>>()
+                        .expect("Failed to parse")
+                })
+            })
+            .collect();
+        for (i, handle) in handles.into_iter().enumerate() {
+            let sentences = handle.join().expect("Parsing thread panicked");
+            assert_eq!(sentences, expected[i % texts.len()]);
+        }
+    });
+}
+
+#[test]
+fn test_parse_batch_preserves_order() {
+    let model = &get_model_state().2;
+    let texts: Vec<String> = (0..20)
+        .map(|i| format!("Document number {i} is here. It has two sentences."))
+        .collect();
+    let expected: Vec<_> = texts
+        .iter()
+        .map(|text| parse_sentences(text).expect("Failed to parse"))
+        .collect();
+
+    let results = model.parse_batch_with(&texts, udpipe_rs::BatchOptions::default().threads(4));
+    assert_eq!(results.len(), texts.len());
+    for (result, expected) in results.into_iter().zip(&expected) {
+        assert_eq!(&result.expect("Failed to parse"), expected);
+    }
+
+    let mut order = Vec::new();
+    model.parse_batch_for_each(&texts, udpipe_rs::BatchOptions::default(), |idx, result| {
+        assert_eq!(&result.expect("Failed to parse"), &expected[idx]);
+        order.push(idx);
+    });
+    assert_eq!(order, (0..texts.len()).collect::<Vec<_>>());
+}
+
+#[test]
+fn test_parallel_parser_matches_sequential() {
+    let model = &get_model_state().2;
+    let text = "The quick brown fox jumps over the lazy dog. She sells seashells. ".repeat(25);
+    let expected = parse_sentences(&text).expect("Failed to parse");
+
+    let sentences = std::thread::scope(|s| {
+        model
+            .parallel_parser(s, &text, udpipe_rs::ParallelOptions::default().workers(4))
+            .expect("Failed to create parser")
+            .collect::<Result<Vec<_>, _>>()
+            .expect("Failed to parse")
+    });
+
+    assert_eq!(sentences, expected);
+}
+
+#[test]
+fn test_parallel_parser_stalls_for_slow_consumer() {
+    // A private model, so its totals count only this test's sentences.
+    let model = udpipe_rs::Model::load(&get_model_state().1).expect("Failed to load model");
+    let text = "The quick brown fox jumps over the lazy dog. ".repeat(200);
+    let total = parse_sentences(&text).expect("Failed to parse").len();
+    model.set_stats_enabled(true);
+
+    let options = udpipe_rs::ParallelOptions::default()
+        .workers(2)
+        .lookahead(3);
+    std::thread::scope(|s| {
+        let mut parser = model
+            .parallel_parser(s, &text, options)
+            .expect("Failed to create parser");
+        parser
+            .next()
+            .expect("No sentence")
+            .expect("Failed to parse");
+        // Leave the tokenizer and workers time to run ahead if they could.
+        std::thread::sleep(std::time::Duration::from_millis(500));
+        // The yielded sentence plus at most `lookahead` in flight.
+        assert!(model.stats().sentences <= 4);
+        assert_eq!(parser.count(), total - 1);
+    });
+}
+
+#[test]
+fn test_pipelined_parser_matches_sequential() {
+    let model = &get_model_state().2;
+    let text = "The quick brown fox jumps over the lazy dog. She sells seashells. ".repeat(25);
+    let expected = parse_sentences(&text).expect("Failed to parse");
+
+    let options = udpipe_rs::PipelineOptions::default()
+        .tag_queue(1)
+        .parse_queue(0);
+    let sentences = std::thread::scope(|s| {
+        model
+            .pipelined_parser(s, &text, options)
+            .expect("Failed to create parser")
+            .collect::<Result<Vec<_>, _>>()
+            .expect("Failed to parse")
+    });
+
+    assert_eq!(sentences, expected);
+}
+
+#[test]
+fn test_reader_parser_matches_whole_text() {
+    let model = &get_model_state().2;
+    let text = "The quick brown fox jumps over the lazy dog. She sells seashells.\n\n".repeat(25);
+    let expected = parse_sentences(&text).expect("Failed to parse");
+
+    // Small blocks, so that the text is read in many pieces.
+    let options = udpipe_rs::ReaderOptions::default().max_block_bytes(100);
+    let sentences = model
+        .reader_parser_with_options(std::io::Cursor::new(&text), options)
+        .expect("Failed to create parser")
+        .collect::<Result<Vec<_>, _>>()
+        .expect("Failed to parse");
+
+    // Whole sentences: block boundaries must not change sentence splits,
+    // multiword tokens or the `# newpar` and `# sent_id` comments.
+    assert_eq!(sentences, expected);
+}
+
+#[test]
+fn test_reader_parser_invalid_utf8() {
+    let model = &get_model_state().2;
+    let input: &[u8] = b"Hello world.\n\nBad \xff byte.";
+    let results: Vec<_> = model
+        .reader_parser(input)
+        .expect("Failed to create parser")
+        .collect();
+
+    assert_eq!(results.len(), 2);
+    assert!(results[0].is_ok());
+    let err = results[1].as_ref().unwrap_err();
+    assert_eq!(err.kind, udpipe_rs::UdpipeErrorKind::ReadFailed);
+}
+
+#[test]
+fn test_parse_stats() {
+    // A private model, so other tests do not add to its totals.
+    let model = udpipe_rs::Model::load(&get_model_state().1).expect("Failed to load model");
+    let text = "The quick brown fox jumps. The lazy dog sleeps.";
+
+    let mut parser = model.parser(text).expect("Failed to create parser");
+    parser.by_ref().for_each(drop);
+    assert_eq!(parser.stats(), udpipe_rs::ParseStats::default());
+
+    model.set_stats_enabled(true);
+    let mut parser = model.parser(text).expect("Failed to create parser");
+    let sentences = parser
+        .by_ref()
+        .collect::<Result<Vec<_>, _>>()
+        .expect("Failed to parse");
+    let stats = parser.stats();
+    assert_eq!(stats.sentences, sentences.len() as u64);
+    assert_eq!(stats.bytes, text.len() as u64);
+    assert!(stats.words >= 10);
+    assert!(stats.tag > std::time::Duration::ZERO);
+    assert!(stats.parse > std::time::Duration::ZERO);
+    assert_eq!(model.stats(), stats);
+
+    model.reset_stats();
+    assert_eq!(model.stats(), udpipe_rs::ParseStats::default());
+}
+
+#[test]
+fn test_parser_stages() {
+    use udpipe_rs::{ParseOptions, Stages};
+
+    let model = &get_model_state().2;
+    let text = "The quick brown fox jumps over the lazy dog.";
+    let full = parse_sentences(text).expect("Failed to parse");
+    let parse_with = |stages| {
+        model
+            .parser_with_options(text, ParseOptions::default().stages(stages))
+            .expect("Failed to create parser")
+            .collect::<Result<Vec<_>, _>>()
+            .expect("Failed to parse")
+    };
+
+    let tokenized = parse_with(Stages::Tokenize);
+    assert_eq!(tokenized.len(), full.len());
+    for (word, full_word) in tokenized[0].words.iter().zip(&full[0].words) {
+        assert_eq!(word.form, full_word.form);
+        assert!(word.upostag.is_empty());
+        assert_eq!(word.head, -1);
+    }
+
+    let tagged = parse_with(Stages::Tag);
+    for (word, full_word) in tagged[0].words.iter().zip(&full[0].words) {
+        assert_eq!(word.lemma, full_word.lemma);
+        assert_eq!(word.upostag, full_word.upostag);
+        assert!(word.deprel.is_empty());
+        assert_eq!(word.head, -1);
+    }
+
+    assert_eq!(parse_with(Stages::Parse), full);
+}
+
+#[test]
+fn test_parser_fields() {
+    use udpipe_rs::{Fields, ParseOptions};
+
+    let model = &get_model_state().2;
+    let text = "The quick brown fox jumps over the lazy dog.";
+    let full = parse_sentences(text).expect("Failed to parse");
+
+    let options = ParseOptions::default().fields(Fields::FORM | Fields::LEMMA);
+    let sentences = model
+        .parser_with_options(text, options)
+        .expect("Failed to create parser")
+        .collect::<Result<Vec<_>, _>>()
+        .expect("Failed to parse");
+
+    assert_eq!(sentences.len(), full.len());
+    for (word, full_word) in sentences[0].words.iter().zip(&full[0].words) {
+        assert_eq!(word.form, full_word.form);
+        assert_eq!(word.lemma, full_word.lemma);
+        assert_eq!(word.head, full_word.head);
+        assert!(word.upostag.is_empty());
+        assert!(word.feats.is_empty());
+        assert!(word.children.is_empty());
+    }
+}
+
+#[test]
+fn test_parse_tokens_matches_tokenized_text() {
+    let model = &get_model_state().2;
+    let text = "The quick brown fox jumps over the lazy dog. It was not amused.";
+    let expected = parse_sentences(text).expect("Failed to parse");
+
+    let tokens: Vec<Vec<&str>> = expected
+        .iter()
+        .map(|sentence| sentence.words.iter().map(|w| w.form.as_str()).collect())
+        .collect();
+    let sentences = model.parse_tokens(&tokens).expect("Failed to parse tokens");
+
+    assert_eq!(sentences.len(), expected.len());
+    for (sentence, expected) in sentences.iter().zip(&expected) {
+        let forms: Vec<_> = sentence.words.iter().map(|w| &w.form).collect();
+        let expected_forms: Vec<_> = expected.words.iter().map(|w| &w.form).collect();
+        assert_eq!(forms, expected_forms);
+        assert!(sentence.words.iter().all(|w| !w.upostag.is_empty()));
+        assert_eq!(sentence.words.iter().filter(|w| w.head == 0).count(), 1);
+    }
+}
+
+#[test]
+fn test_presegmented_input() {
+    let model = &get_model_state().2;
+    let options = udpipe_rs::ParseOptions::default().presegmented(true);
+    let sentences = model
+        .parser_with_options(
+            "This is one line. Still the same sentence\nSecond line",
+            options,
+        )
+        .expect("Failed to create parser")
+        .collect::<Result<Vec<_>, _>>()
+        .expect("Failed to parse");
+    assert_eq!(sentences.len(), 2);
+}
+
+#[test]
+fn test_word_offsets() {
+    let model = &get_model_state().2;
+    let text = "Café prices rose in Zürich.\n\nThe naïve fox slept.";
+    let options = udpipe_rs::ParseOptions::default().offsets(true);
+    let sentences = model
+        .parser_with_options(text, options)
+        .expect("Failed to create parser")
+        .collect::<Result<Vec<_>, _>>()
+        .expect("Failed to parse");
+    for word in sentences.iter().flat_map(|s| &s.words) {
+        assert_eq!(&text[word.start..word.end], word.form);
+    }
+
+    // Offsets from a streamed input are relative to the whole input.
+    let reader_options = udpipe_rs::ReaderOptions::default().parse_options(options);
+    let streamed = model
+        .reader_parser_with_options(text.as_bytes(), reader_options)
+        .expect("Failed to create parser")
+        .collect::<Result<Vec<_>, _>>()
+        .expect("Failed to parse");
+    assert_eq!(streamed.len(), sentences.len());
+    for (streamed, sentence) in streamed.iter().zip(&sentences) {
+        assert_eq!(streamed.words, sentence.words);
+    }
+}
+
+#[test]
+fn test_word_offsets_across_blocks() {
+    let model = &get_model_state().2;
+    // One block per paragraph, each longer than the last, so that later
+    // blocks outgrow (and reallocate) the buffer of earlier ones. Blocks are
+    // small enough that no paragraph is cut.
+    let text: String = (1..=12)
+        .map(|n| "Señor Müller aß crème brûlée. ".repeat(n) + "\n\n")
+        .collect();
+    let options = udpipe_rs::ParseOptions::default().offsets(true);
+    let whole = model
+        .parser_with_options(&text, options)
+        .expect("Failed to create parser")
+        .collect::<Result<Vec<_>, _>>()
+        .expect("Failed to parse");
+
+    let reader_options = udpipe_rs::ReaderOptions::default()
+        .max_block_bytes(512)
+        .parse_options(options);
+    let streamed = model
+        .reader_parser_with_options(text.as_bytes(), reader_options)
+        .expect("Failed to create parser")
+        .collect::<Result<Vec<_>, _>>()
+        .expect("Failed to parse");
+    assert_eq!(streamed.len(), whole.len());
+    for (streamed, whole) in streamed.iter().zip(&whole) {
+        assert_eq!(streamed.words, whole.words);
+    }
+    for word in streamed.iter().flat_map(|s| &s.words) {
+        assert_eq!(&text[word.start..word.end], word.form);
+    }
+}
+
+#[test]
+fn test_word_offsets_off_by_default() {
+    let sentences = parse_sentences("Hello world.").expect("Failed to parse");
+    for word in &sentences[0].words {
+        assert_eq!((word.start, word.end), (0, 0));
+    }
+}
+
+#[test]
+fn test_reusable_parser_matches_fresh_parser() {
+    let model = &get_model_state().2;
+    let mut parser = model.reusable_parser().expect("Failed to create parser");
+    for text in ["Hello world.", "", "The quick brown fox. It jumps.", "Bye"] {
+        // An owned copy, dropped after each document.
+        let text = text.to_owned();
+        let sentences = parser
+            .parse(&text)
+            .expect("Failed to reset parser")
+            .collect::<Result<Vec<_>, _>>()
+            .expect("Failed to parse");
+        let expected = parse_sentences(&text).expect("Failed to parse");
+        assert_eq!(sentences.len(), expected.len());
+        for (sentence, expected) in sentences.iter().zip(&expected) {
+            assert_eq!(sentence.words, expected.words);
+        }
+    }
+}
+
+#[test]
+fn test_parse_columnar_matches_sentences() {
+    let model = &get_model_state().2;
+    let texts = [
+        "The quick brown fox jumps.",
+        "",
+        "She sells seashells. He runs.",
+    ];
+    let batch = model.parse_columnar(&texts).expect("Failed to parse");
+
+    assert_eq!(batch.document_count(), texts.len());
+    let mut row = 0;
+    let mut sentence_index = 0;
+    for (doc, text) in texts.iter().enumerate() {
+        let sentences = parse_sentences(text).expect("Failed to parse");
+        let first = batch.document_offsets()[doc] as usize;
+        assert_eq!(
+            batch.document_offsets()[doc + 1] as usize - first,
+            sentences.len()
+        );
+        for sentence in &sentences {
+            assert_eq!(
+                batch.sentence_words(sentence_index),
+                Some(row..row + sentence.words.len())
+            );
+            for word in &sentence.words {
+                assert_eq!(batch.forms().get(row), Some(word.form.as_str()));
+                assert_eq!(batch.lemmas().get(row), Some(word.lemma.as_str()));
+                let upostag = u32::from(batch.upostags()[row]);
+                assert_eq!(
+                    batch.upostag_vocab().get(upostag),
+                    Some(word.upostag.as_str())
+                );
+                let deprel = u32::from(batch.deprels()[row]);
+                assert_eq!(batch.deprel_vocab().get(deprel), Some(word.deprel.as_str()));
+                assert_eq!(batch.heads()[row], word.head);
+                row += 1;
+            }
+            sentence_index += 1;
+        }
+    }
+    assert_eq!(batch.word_count(), row);
+    assert_eq!(batch.sentence_count(), sentence_index);
+}
+
+#[cfg(feature = "arrow")]
+#[test]
+fn test_record_batch_matches_columnar() {
+    use arrow_array::cast::AsArray;
+    use arrow_array::types::{UInt8Type, UInt16Type, UInt32Type};
+
+    let model = &get_model_state().2;
+    let texts = [
+        "The quick brown fox jumps.",
+        "She sells seashells. He runs.",
+    ];
+    let batch = model.parse_columnar(&texts).expect("Failed to parse");
+    let record_batch = batch
+        .clone()
+        .into_record_batch()
+        .expect("Failed to convert");
+
+    assert_eq!(record_batch.num_rows(), batch.word_count());
+    let column = |name| record_batch.column_by_name(name).expect("Missing column");
+    let forms = column("form").as_string::<i32>();
+    let upos = column("upos").as_dictionary::<UInt8Type>();
+    let upos_values = upos.values().as_string::<i32>();
+    let deprel = column("deprel").as_dictionary::<UInt16Type>();
+    let deprel_values = deprel.values().as_string::<i32>();
+    let documents = column("document").as_primitive::<UInt32Type>();
+    for row in 0..batch.word_count() {
+        assert_eq!(Some(forms.value(row)), batch.forms().get(row));
+        let upostag = batch.upostag_vocab().get(u32::from(batch.upostags()[row]));
+        assert_eq!(
+            Some(upos_values.value(usize::from(upos.keys().value(row)))),
+            upostag
+        );
+        let relation = batch.deprel_vocab().get(u32::from(batch.deprels()[row]));
+        assert_eq!(
+            Some(deprel_values.value(usize::from(deprel.keys().value(row)))),
+            relation
+        );
+    }
+    assert_eq!(documents.value(0), 0);
+    assert_eq!(documents.value(batch.word_count() - 1), 1);
+}
+
+#[test]
+fn test_replicated_model_matches_model() {
+    let model_path = &get_model_state().1;
+    let text = "The quick brown fox jumps over the lazy dog. It was not amused.";
+    let expected = parse_sentences(text).expect("Failed to parse");
+
+    // Two replicas on the same node, so that replication runs on any machine.
+    let cpus = udpipe_rs::ReplicatedModel::numa_nodes()
+        .into_iter()
+        .next()
+        .unwrap_or_default();
+    // Threads can only be pinned where the topology is known (on Linux).
+    let pinnable = !cpus.is_empty();
+    let model = udpipe_rs::ReplicatedModel::load_for_cpus(model_path, &[cpus.clone(), cpus])
+        .expect("Failed to load replicas");
+    assert_eq!(model.replicas().len(), 2);
+    std::thread::scope(|s| {
+        for replica in 0..2 {
+            let model = &model;
+            let expected = &expected;
+            s.spawn(move || {
+                let local = if pinnable {
+                    model
+                        .bind_current_thread(replica)
+                        .expect("Failed to pin thread")
+                } else {
+                    &model.replicas()[replica]
+                };
+                let sentences: Vec<_> = local
+                    .parser(text)
+                    .expect("Failed to create parser")
+                    .collect::<Result<_, _>>()
+                    .expect("Failed to parse");
+                assert_eq!(&sentences, expected);
+                assert!(std::ptr::eq(model.local(), model.replicas().as_ptr()));
+            });
+        }
+    });
+
+    let single = udpipe_rs::ReplicatedModel::load_for_cpus(model_path, &[vec![0]])
+        .expect("Failed to load model");
+    assert_eq!(single.replicas().len(), 1);
+}
+
+#[test]
+fn test_parse_corpus_matches_parser() {
+    let model = &get_model_state().2;
+    let long = "Sentence number one is here. ".repeat(40);
+    let texts = [
+        long.as_str(),
+        "Hello world!",
+        "",
+        "The cat sat. The dog ran.",
+    ];
+    let options = udpipe_rs::CorpusOptions::default()
+        .workers(3)
+        .split_bytes(100)
+        .chunk_sentences(4);
+    let output = model
+        .parse_corpus(&texts, options)
+        .expect("Failed to start workers");
+
+    assert_eq!(output.documents.len(), texts.len());
+    for (result, text) in output.documents.into_iter().zip(texts) {
+        assert_eq!(
+            result.expect("Failed to parse"),
+            parse_sentences(text).expect("Failed to parse")
+        );
+    }
+    assert_eq!(output.workers.len(), 3);
+    let sentences: u64 = output.workers.iter().map(|w| w.sentences).sum();
+    assert_eq!(sentences, 43);
+}
+
+#[test]
+fn test_micro_batcher_matches_parser() {
+    let model = udpipe_rs::Model::load(&get_model_state().1).expect("Failed to load model");
+    let options = udpipe_rs::MicroBatchOptions::default()
+        .workers(1)
+        .max_wait(std::time::Duration::from_millis(5));
+    let batcher = udpipe_rs::MicroBatcher::new(std::sync::Arc::new(model), options)
+        .expect("Failed to start batcher");
+    let texts = ["The cat sat. The dog ran.", "Hello world!", "", "She runs."];
+
+    std::thread::scope(|s| {
+        for text in texts {
+            let batcher = &batcher;
+            s.spawn(move || {
+                assert_eq!(
+                    batcher.parse(text).expect("Failed to parse"),
+                    parse_sentences(text).expect("Failed to parse")
+                );
+            });
+        }
+    });
+
+    let stats = batcher.stats();
+    assert_eq!(stats.requests, texts.len() as u64);
+    assert!(stats.batches >= 1 && stats.batches <= stats.requests);
+    assert_eq!(stats.sentences, 4);
+    assert!(stats.queue_max >= stats.queue_mean());
+}
+
+/// Tests of the async front-end, driven by a minimal executor so that they
+/// need no async runtime.
+#[cfg(feature = "async")]
+mod service {
+    use std::future::Future;
+    use std::sync::{Arc, Condvar, Mutex};
+    use std::task::{Context, Poll, Wake, Waker};
+
+    use futures_core::Stream;
+    use udpipe_rs::{AsyncOptions, ParseService};
+
+    use super::{get_model_state, parse_sentences};
+
+    /// Wakes a thread blocked in [`block_on`].
+    #[derive(Default)]
+    struct Signal {
+        /// Whether the future was woken since it was last polled.
+        woken: Mutex<bool>,
+        /// Signalled on wake.
+        ready: Condvar,
+    }
+
+    impl Wake for Signal {
+        fn wake(self: Arc<Self>) {
+            *self.woken.lock().expect("Poisoned") = true;
+            self.ready.notify_one();
+        }
+    }
+
+    /// Run `future` to completion on the current thread.
+    fn block_on<F: Future>(future: F) -> F::Output {
+        let mut future = std::pin::pin!(future);
+        let signal = Arc::new(Signal::default());
+        let waker = Waker::from(Arc::clone(&signal));
+        let mut cx = Context::from_waker(&waker);
+        loop {
+            if let Poll::Ready(output) = future.as_mut().poll(&mut cx) {
+                return output;
+            }
+            let mut woken = signal.woken.lock().expect("Poisoned");
+            while !*woken {
+                woken = signal.ready.wait(woken).expect("Poisoned");
+            }
+            *woken = false;
+        }
+    }
+
+    /// A service over a copy of the shared model.
+    fn service() -> ParseService {
+        let model = udpipe_rs::Model::load(&get_model_state().1).expect("Failed to load model");
+        ParseService::new(Arc::new(model), AsyncOptions::default().workers(2))
+            .expect("Failed to start service")
+    }
+
+    #[test]
+    fn test_parse_service_batch_matches_parser() {
+        let texts = ["The cat sat. The dog ran.", "Hello world!", ""];
+        let service = service();
+        let results = block_on(service.parse_batch(texts));
+
+        assert_eq!(results.len(), texts.len());
+        for (result, text) in results.into_iter().zip(texts) {
+            assert_eq!(
+                result.expect("Failed to parse"),
+                parse_sentences(text).expect("Failed to parse")
+            );
+        }
+    }
+
+    #[test]
+    fn test_parse_service_stream_matches_parser() {
+        let text = "She sells seashells. He runs. They sit.";
+        let service = service();
+        let mut stream = service.parse(text);
+        let mut sentences = Vec::new();
+        while let Some(sentence) = block_on(std::future::poll_fn(|cx| {
+            std::pin::Pin::new(&mut stream).poll_next(cx)
+        })) {
+            sentences.push(sentence.expect("Failed to parse"));
+        }
+
+        assert_eq!(sentences, parse_sentences(text).expect("Failed to parse"));
+    }
+}